@@ -0,0 +1,143 @@
+// Offline world pre-generation: bakes square of regions around origin into BakedRegion files, the engine then loads them
+// instead of generating (BAKED_WORLD in config.h). Regions are baked in parallel, each by one thread with its own ChunkManager,
+// which generates region and GENERATION_MARGIN rings around it, so chunks of region are complete and nothing is shared between threads.
+// World generator settings are taken from config.h, same as the engine uses, region files store only seed.
+//
+// Usage: ChunkBaker <directory> <radius> [seed] [--scaling]
+//   radius    in regions, regions -radius ... radius - 1 along both axes are baked, (2 * radius)^2 regions of REGION_CHUNKS^2 chunks
+//   seed      SEED from config.h by default
+//   --scaling bakes the same area with 1, 2, 4 ... N threads (N = all cores), so chunks/s of each can be compared
+// Output is JSON on stdout, chunks/s of every run and speedup against the first one. Exit code is 1 when any region is not written.
+
+#include "game/chunks/ChunkManager.h"
+#include "config.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std::chrono;
+
+struct BakeResult
+{
+	int threads = 0;
+	size_t chunks = 0;
+	size_t bytes = 0;		// of all written records
+	double seconds = 0;
+};
+
+// chunks of region, 0 when it was not written
+static size_t BakeRegion(int seed, int region_x, int region_z, const std::string& directory, size_t& bytes)
+{
+	// GenerateArea is square around center chunk, radius REGION_CHUNKS / 2 covers whole region (and one more row and column)
+	const int radius = BakedRegion::REGION_CHUNKS / 2;
+	const int first_x = region_x * BakedRegion::REGION_CHUNKS, first_z = region_z * BakedRegion::REGION_CHUNKS;
+	const int center_x = first_x + radius, center_z = first_z + radius;
+	const glm::vec3 center_position((center_x + 0.5f) * CHUNK_SIZE_X, 140.0f, (center_z + 0.5f) * CHUNK_SIZE_Z);
+	ChunkManager chunk_manager(radius, center_position, seed);
+	chunk_manager.GenerateArea(center_x, center_z, radius);
+
+	BakedRegion region(seed, chunk_manager.GetWorldGenerator().GetSettingsFingerprint(), region_x, region_z);
+	std::vector<uint8_t> record;
+	for (int z = 0; z < BakedRegion::REGION_CHUNKS; ++z)
+		for (int x = 0; x < BakedRegion::REGION_CHUNKS; ++x)
+		{
+			chunk_manager.FindChunk(first_x + x, first_z + z)->WriteBaked(record);
+			region.SetChunk(x, z, record);
+		}
+	if (!region.Write(BakedRegion::GetPath(directory, region_x, region_z)))
+		return 0;
+	bytes = region.GetSize();
+	return (size_t)BakedRegion::REGION_CHUNKS * BakedRegion::REGION_CHUNKS;
+}
+
+static BakeResult BakeArea(int seed, int radius, const std::string& directory, int threads)
+{
+	const int side = 2 * radius;
+	BakeResult result{ threads };
+	size_t chunks = 0, bytes = 0;
+	auto start = high_resolution_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(dynamic) reduction(+:chunks, bytes)
+#endif
+	for (int i = 0; i < side * side; ++i)
+	{
+		size_t region_bytes = 0;
+		chunks += BakeRegion(seed, i % side - radius, i / side - radius, directory, region_bytes);
+		bytes += region_bytes;
+	}
+	result.seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+	result.chunks = chunks;
+	result.bytes = bytes;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<const char*> arguments;
+	bool scaling = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--scaling") == 0)
+			scaling = true;
+		else
+			arguments.push_back(argv[i]);
+	}
+	if (arguments.size() < 2 || std::atoi(arguments[1]) < 1)
+	{
+		std::cerr << "Usage: ChunkBaker <directory> <radius> [seed] [--scaling]" << std::endl;
+		return 1;
+	}
+	const std::string directory = arguments[0];
+	const int radius = std::atoi(arguments[1]);
+	const int seed = arguments.size() > 2 ? std::atoi(arguments[2]) : SEED;
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	int max_threads = 1;
+#ifdef _OPENMP
+	max_threads = omp_get_max_threads();
+	omp_set_max_active_levels(1);	// GenerateArea inside of region runs on thread of its region
+#endif
+	std::vector<int> thread_counts;
+	if (scaling)
+		for (int threads = 1; threads < max_threads; threads *= 2)
+			thread_counts.push_back(threads);
+	thread_counts.push_back(max_threads);
+
+	std::vector<BakeResult> results;
+	for (int threads : thread_counts)
+		results.push_back(BakeArea(seed, radius, directory, threads));
+
+	const size_t expected_chunks = (size_t)4 * radius * radius * BakedRegion::REGION_CHUNKS * BakedRegion::REGION_CHUNKS;
+	bool written = true;
+	std::cout.setf(std::ios::fixed);
+	std::cout.precision(1);
+	std::cout << "{" << std::endl;
+	std::cout << "  \"directory\": \"" << directory << "\", \"seed\": " << seed << ", \"regions\": " << 4 * radius * radius
+		<< ", \"chunks\": " << expected_chunks << "," << std::endl;
+	std::cout << "  \"runs\": [" << std::endl;
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const BakeResult& result = results[i];
+		written = written && result.chunks == expected_chunks;
+		std::cout << "    {"
+			<< "\"threads\": " << result.threads
+			<< ", \"seconds\": " << std::setprecision(3) << result.seconds << std::setprecision(1)
+			<< ", \"chunks_per_second\": " << result.chunks / result.seconds
+			<< ", \"speedup\": " << std::setprecision(2) << results[0].seconds / result.seconds << std::setprecision(1)
+			<< ", \"bytes_per_chunk\": " << (result.chunks ? (double)result.bytes / result.chunks : 0.0)
+			<< ", \"written_chunks\": " << result.chunks
+			<< "}" << (i + 1 == results.size() ? "" : ",") << std::endl;
+	}
+	std::cout << "  ]" << std::endl;
+	std::cout << "}" << std::endl;
+	return written ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Baked ambient occlusion (BAKED_AO): Chunk::BuildMesh of the same render area without and with occlusion, quads and ns per chunk
+// of each. All chunks are meshed at LOD 1, occlusion is computed only there. Every chunk is meshed both ways right after each other
+// and its time is the fastest of AO_PASSES passes.
+// Only measures, it never fails.
+
+#include "Benchmark.h"
+#include <algorithm>
+using namespace std::chrono;
+
+static const int AO_RENDER_DISTANCE = 8;
+static const int AO_PASSES = 5;	// difference is few %, single pass is too noisy for it
+
+static void RunAo(int seed, std::vector<std::string>& records)
+{
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);
+	ChunkManager chunk_manager(AO_RENDER_DISTANCE, start_position, seed);
+	chunk_manager.GenerateArea(0, 0, AO_RENDER_DISTANCE);
+
+	std::vector<Chunk*> rendered;
+	for (int z = -AO_RENDER_DISTANCE; z <= AO_RENDER_DISTANCE; ++z)
+		for (int x = -AO_RENDER_DISTANCE; x <= AO_RENDER_DISTANCE; ++x)
+			rendered.push_back(chunk_manager.FindChunk(x, z));
+
+	// both ways right after each other for every chunk, fastest of passes per chunk, so preempted builds do not count
+	std::vector<high_resolution_clock::duration> fastest[2];
+	size_t quads[2] = {};
+	for (int pass = 0; pass < AO_PASSES; ++pass)
+		for (size_t i = 0; i < rendered.size(); ++i)
+			for (bool ao : { false, true })
+			{
+				chunk_manager.SetBakedAo(ao);
+				auto start = high_resolution_clock::now();
+				rendered[i]->BuildMesh();
+				const high_resolution_clock::duration duration = high_resolution_clock::now() - start;
+				if (pass == 0)
+				{
+					fastest[ao].push_back(duration);
+					quads[ao] += rendered[i]->GetVertexCount() / 4;
+				}
+				else
+					fastest[ao][i] = std::min(fastest[ao][i], duration);
+			}
+	double build_mesh_ns[2];
+	for (bool ao : { false, true })
+	{
+		high_resolution_clock::duration total{};
+		for (const high_resolution_clock::duration& duration : fastest[ao])
+			total += duration;
+		build_mesh_ns[ao] = NsPerItem(total, rendered.size());
+	}
+	chunk_manager.SetBakedAo(BAKED_AO);
+
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("meshed_chunks", rendered.size())
+		.Add("build_mesh_ns_per_chunk", build_mesh_ns[0])
+		.Add("ao_build_mesh_ns_per_chunk", build_mesh_ns[1])
+		.AddFixed("cost_ratio", build_mesh_ns[1] / build_mesh_ns[0], 2)
+		.Add("quads", quads[0])
+		.Add("ao_quads", quads[1])
+		.AddFixed("quad_ratio", (double)quads[1] / quads[0], 2)
+		.Str());
+}
+
+bool RunAoCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	for (int seed : seeds)
+		RunAo(seed, records);
+	return true;
+}
@@ -0,0 +1,88 @@
+// Whole area as in game, one record per seed and render distance, all times in ns per chunk:
+//   generate     - ChunkManager::GenerateArea, all stages, every chunk of generation area (render distance + GENERATION_MARGIN)
+//   build_mesh   - Chunk::BuildMesh, every chunk of render area (LOD by distance, same as in game)
+//   get_block    - Chunk::GetBlock for all CHUNK_VOLUME blocks of a chunk, render area
+//   update_center - ChunkManager::UpdateCenter moving one chunk along x, per newly generated chunk (includes its meshing)
+// Only measures, it never fails.
+
+#include "Benchmark.h"
+using namespace std::chrono;
+
+static const int RENDER_DISTANCES[] = { 4, 8, 16 };
+static const int UPDATE_CENTER_STEPS = 8;
+
+static std::string RunArea(int seed, int render_distance)
+{
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);	// chunk 0, 0 is center
+	ChunkManager chunk_manager(render_distance, start_position, seed);
+
+	// generate, same as ChunkManager::GenerateChunks, outer GENERATION_MARGIN rings are generated only partially
+	const int generation_distance = render_distance + GENERATION_MARGIN;
+	auto start = high_resolution_clock::now();
+	chunk_manager.GenerateArea(0, 0, render_distance);
+	const size_t generated_chunks = chunk_manager.GetChunkCount();
+	const double generate_ns = NsPerItem(high_resolution_clock::now() - start, generated_chunks);
+
+	std::vector<Chunk*> rendered;
+	for (int z = -render_distance; z <= render_distance; ++z)
+		for (int x = -render_distance; x <= render_distance; ++x)
+			rendered.push_back(chunk_manager.FindChunk(x, z));
+
+	start = high_resolution_clock::now();
+	for (Chunk* chunk : rendered)
+	{
+		const glm::i64vec3 position = chunk->GetGlobalPosition();
+		const long long int distance = std::max(std::abs(position.x), std::abs(position.z));
+		int lod = 1;
+		if (LOD_MESHING)
+			lod = distance >= LOD_RING_8X ? 8 : distance >= LOD_RING_4X ? 4 : distance >= LOD_RING_2X ? 2 : 1;
+		chunk->BuildMesh(lod);
+	}
+	const double build_mesh_ns = NsPerItem(high_resolution_clock::now() - start, rendered.size());
+	size_t vertices = 0;
+	size_t chunks_memory = 0;
+	for (const Chunk* chunk : rendered)
+	{
+		vertices += chunk->GetVertexCount();
+		chunks_memory += chunk->MemoryUsage();
+	}
+
+	// non air blocks, keeps the loop alive and catches generator changes
+	uint64_t checksum = 0;
+	start = high_resolution_clock::now();
+	for (const Chunk* chunk : rendered)
+		for (int y = 0; y < CHUNK_SIZE_Y; ++y)
+			for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+				for (int x = 0; x < CHUNK_SIZE_X; ++x)
+					checksum += chunk->GetBlock(x, y, z) != BlockId::Air;
+	const double get_block_ns = NsPerItem(high_resolution_clock::now() - start, rendered.size());
+
+	// every step unloads one column of chunks, generates new one and meshes newly visible chunks
+	start = high_resolution_clock::now();
+	for (int step = 1; step <= UPDATE_CENTER_STEPS; ++step)
+		chunk_manager.UpdateCenter(start_position + glm::vec3(step * CHUNK_SIZE_X, 0.0f, 0.0f));
+	const size_t new_chunks = (size_t)UPDATE_CENTER_STEPS * (2 * generation_distance + 1);
+	const double update_center_ns = NsPerItem(high_resolution_clock::now() - start, new_chunks);
+
+	return JsonRecord()
+		.Add("seed", seed)
+		.Add("render_distance", render_distance)
+		.Add("generated_chunks", generated_chunks)
+		.Add("meshed_chunks", rendered.size())
+		.Add("generate_ns_per_chunk", generate_ns)
+		.Add("build_mesh_ns_per_chunk", build_mesh_ns)
+		.Add("get_block_ns_per_chunk", get_block_ns)
+		.Add("update_center_ns_per_chunk", update_center_ns)
+		.Add("vertices", vertices)
+		.Add("chunks_memory", chunks_memory)
+		.Add("checksum", checksum)
+		.Str();
+}
+
+bool RunAreaCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	for (int seed : seeds)
+		for (int render_distance : RENDER_DISTANCES)
+			records.push_back(RunArea(seed, render_distance));
+	return true;
+}
@@ -0,0 +1,86 @@
+// Meshing arena (MESHING_ARENA): Chunk::BuildMesh of the same render area with fresh arena per call and with per thread MeshingArena,
+// heap allocations and ns per chunk of each, area is meshed once before with arena, so it is already grown. Every chunk is meshed
+// both ways right after each other and its time is the fastest of ARENA_PASSES passes, allocations are of all passes.
+// Fails when meshing with arena allocates anything or any chunk gets different vertex count.
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+using namespace std::chrono;
+
+static const int ARENA_RENDER_DISTANCE = 8;
+static const int ARENA_PASSES = 5;	// single pass is too noisy for the time difference
+
+static bool RunArena(int seed, std::vector<std::string>& records)
+{
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);
+	ChunkManager chunk_manager(ARENA_RENDER_DISTANCE, start_position, seed);
+	chunk_manager.GenerateArea(0, 0, ARENA_RENDER_DISTANCE);
+
+	std::vector<Chunk*> rendered;
+	std::vector<int> lods;	// same as area check
+	for (int z = -ARENA_RENDER_DISTANCE; z <= ARENA_RENDER_DISTANCE; ++z)
+		for (int x = -ARENA_RENDER_DISTANCE; x <= ARENA_RENDER_DISTANCE; ++x)
+		{
+			const int distance = std::max(std::abs(x), std::abs(z));
+			rendered.push_back(chunk_manager.FindChunk(x, z));
+			lods.push_back(!LOD_MESHING ? 1 : distance >= LOD_RING_8X ? 8 : distance >= LOD_RING_4X ? 4 : distance >= LOD_RING_2X ? 2 : 1);
+		}
+
+	chunk_manager.SetMeshingArena(true);
+	std::vector<size_t> expected_vertices;
+	for (size_t i = 0; i < rendered.size(); ++i)
+	{
+		rendered[i]->BuildMesh(lods[i]);
+		expected_vertices.push_back(rendered[i]->GetVertexCount());
+	}
+
+	// both ways right after each other for every chunk, fastest of passes per chunk, so preempted builds do not count
+	std::vector<high_resolution_clock::duration> fastest[2];
+	size_t allocations[2] = {}, vertex_mismatches[2] = {};
+	for (int pass = 0; pass < ARENA_PASSES; ++pass)
+		for (size_t i = 0; i < rendered.size(); ++i)
+			for (bool arena : { false, true })
+			{
+				chunk_manager.SetMeshingArena(arena);
+				const size_t allocations_before = GetAllocationCount();
+				auto start = high_resolution_clock::now();
+				rendered[i]->BuildMesh(lods[i]);
+				const high_resolution_clock::duration duration = high_resolution_clock::now() - start;
+				allocations[arena] += GetAllocationCount() - allocations_before;
+				vertex_mismatches[arena] += rendered[i]->GetVertexCount() != expected_vertices[i];
+				if (pass == 0)
+					fastest[arena].push_back(duration);
+				else
+					fastest[arena][i] = std::min(fastest[arena][i], duration);
+			}
+
+	bool match = true;
+	for (bool arena : { false, true })
+	{
+		high_resolution_clock::duration total{};
+		for (const high_resolution_clock::duration& duration : fastest[arena])
+			total += duration;
+		const size_t builds = rendered.size() * ARENA_PASSES;
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("meshing_arena", arena)
+			.Add("meshed_chunks", rendered.size())
+			.Add("build_mesh_ns_per_chunk", NsPerItem(total, rendered.size()))
+			.Add("allocations", allocations[arena])
+			.AddFixed("allocations_per_chunk", (double)allocations[arena] / builds, 2)
+			.Add("vertex_mismatches", vertex_mismatches[arena])
+			.Str());
+		match = match && (!arena || allocations[arena] == 0) && vertex_mismatches[arena] == 0;
+	}
+	chunk_manager.SetMeshingArena(MESHING_ARENA);
+	return match;
+}
+
+bool RunArenaCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+		match = RunArena(seed, records) && match;
+	return match;
+}
@@ -0,0 +1,130 @@
+// Baked chunks (BakedRegion, ChunkBaker), first seed: lit chunks of render distance BAKED_RENDER_DISTANCE are baked into region files,
+// then area is generated again with them loaded. Fails when not all of them are loaded, or any block (also of decorated ring around
+// them, its trees reach into baked chunks) or height summary differs from generated area, or when generator with other settings
+// (density terrain flipped) loads any of them.
+
+#include "Benchmark.h"
+#include "game/chunks/BakedRegion.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+using namespace std::chrono;
+
+static const int BAKED_RENDER_DISTANCE = 4;
+
+static bool SameSummary(const HeightSummary& a, const HeightSummary& b)
+{
+	return a.min_y == b.min_y && a.max_y == b.max_y && a.solid_top == b.solid_top && a.water_min_y == b.water_min_y &&
+		a.water_max_y == b.water_max_y && a.heightmap == b.heightmap;
+}
+
+// chunk with most trees on grass among scattered height chunks, so trees of baked chunks reach into decorated ring around them
+static glm::ivec2 BakedCenter(int seed)
+{
+	const WorldGenerator world_generator(seed);
+	ChunkHeights heights;
+	std::array<BlockSpan, MAX_COLUMN_SPANS> spans;
+	glm::ivec2 center(0, 0);
+	int most_trees = -1;
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+	{
+		const glm::ivec2 position = HeightChunkPosition(i);
+		world_generator.GenerateHeights(position.x * CHUNK_SIZE_X, position.y * CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights.data());
+		int trees = 0;
+		for (const HeightPayload& height : heights)
+			trees += height.should_place_tree && spans[world_generator.GetColumnSpans(height, spans.data()) - 1].block == BlockId::Grass;
+		if (trees > most_trees)
+		{
+			most_trees = trees;
+			center = position;
+		}
+	}
+	return center;
+}
+
+bool RunBakedCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	const int seed = seeds.front();
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rt-voxel-engine-benchmark-baked";
+	std::filesystem::create_directories(directory);
+
+	const glm::ivec2 center = BakedCenter(seed);
+	const glm::vec3 center_position((center.x + 0.5f) * CHUNK_SIZE_X, 140.0f, (center.y + 0.5f) * CHUNK_SIZE_Z);
+	ChunkManager generated(BAKED_RENDER_DISTANCE, center_position, seed);
+	auto start = high_resolution_clock::now();
+	generated.GenerateArea(center.x, center.y, BAKED_RENDER_DISTANCE);
+	// per chunk of area (with GENERATION_MARGIN rings), GenerateArea without and with baked chunks
+	const double generate_ns = NsPerItem(high_resolution_clock::now() - start, generated.GetChunkCount());
+
+	// area can span more regions
+	std::vector<BakedRegion> regions;
+	std::vector<std::vector<uint8_t>> baked_records;
+	size_t bytes = 0;
+	for (int z = center.y - BAKED_RENDER_DISTANCE; z <= center.y + BAKED_RENDER_DISTANCE; ++z)
+		for (int x = center.x - BAKED_RENDER_DISTANCE; x <= center.x + BAKED_RENDER_DISTANCE; ++x)
+		{
+			const int region_x = (int)std::floor((float)x / BakedRegion::REGION_CHUNKS);
+			const int region_z = (int)std::floor((float)z / BakedRegion::REGION_CHUNKS);
+			auto region = std::find_if(regions.begin(), regions.end(),
+				[=](const BakedRegion& region) { return region.GetRegionX() == region_x && region.GetRegionZ() == region_z; });
+			if (region == regions.end())
+				region = regions.emplace(regions.end(), seed, generated.GetWorldGenerator().GetSettingsFingerprint(), region_x, region_z);
+			baked_records.emplace_back();
+			generated.FindChunk(x, z)->WriteBaked(baked_records.back());
+			region->SetChunk(x - region_x * BakedRegion::REGION_CHUNKS, z - region_z * BakedRegion::REGION_CHUNKS, baked_records.back());
+			bytes += baked_records.back().size();
+		}
+	for (const BakedRegion& region : regions)
+		region.Write(BakedRegion::GetPath(directory.string(), region.GetRegionX(), region.GetRegionZ()));
+
+	ChunkManager baked(BAKED_RENDER_DISTANCE, center_position, seed);
+	baked.SetBakedWorld(directory.string());
+	start = high_resolution_clock::now();
+	baked.GenerateArea(center.x, center.y, BAKED_RENDER_DISTANCE);
+	const double baked_ns = NsPerItem(high_resolution_clock::now() - start, baked.GetChunkCount());
+
+	// region has to be rejected by generator with other settings
+	ChunkManager other_settings(BAKED_RENDER_DISTANCE, center_position, seed);
+	other_settings.GetWorldGenerator().SetDensityTerrain(!DENSITY_TERRAIN);
+	other_settings.SetBakedWorld(directory.string());
+	other_settings.GenerateArea(center.x, center.y, BAKED_RENDER_DISTANCE);
+
+	// Chunk::ReadBaked only, per baked chunk
+	Chunk chunk(glm::i64vec3(0), baked);
+	start = high_resolution_clock::now();
+	for (const std::vector<uint8_t>& record : baked_records)
+		chunk.ReadBaked(record.data(), record.size());
+	const double read_ns = NsPerItem(high_resolution_clock::now() - start, baked_records.size());
+
+	size_t block_mismatches = 0, summary_mismatches = 0;
+	const int compared = BAKED_RENDER_DISTANCE + 1;
+	for (int z = center.y - compared; z <= center.y + compared; ++z)
+		for (int x = center.x - compared; x <= center.x + compared; ++x)
+		{
+			const Chunk* expected = generated.FindChunk(x, z);
+			const Chunk* actual = baked.FindChunk(x, z);
+			summary_mismatches += !SameSummary(expected->GetHeightSummary(), actual->GetHeightSummary());
+			for (int y = 0; y < CHUNK_SIZE_Y; ++y)
+				for (int block_z = 0; block_z < CHUNK_SIZE_Z; ++block_z)
+					for (int block_x = 0; block_x < CHUNK_SIZE_X; ++block_x)
+						block_mismatches += expected->GetBlock(block_x, y, block_z) != actual->GetBlock(block_x, y, block_z);
+		}
+	std::filesystem::remove_all(directory);
+
+	const size_t baked_chunks = baked_records.size();
+	const size_t loaded_chunks = baked.GetLoadedBakedChunks();
+	const size_t stale_loaded_chunks = other_settings.GetLoadedBakedChunks();
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("baked_chunks", baked_chunks)
+		.Add("loaded_chunks", loaded_chunks)
+		.Add("bytes_per_chunk", (double)bytes / baked_chunks)
+		.Add("generate_ns_per_chunk", generate_ns)
+		.Add("baked_ns_per_chunk", baked_ns)
+		.Add("read_ns_per_chunk", read_ns)
+		.Add("block_mismatches", block_mismatches)
+		.Add("summary_mismatches", summary_mismatches)
+		.Add("stale_loaded_chunks", stale_loaded_chunks)
+		.Str());
+	return loaded_chunks == baked_chunks && block_mismatches == 0 && summary_mismatches == 0 && stale_loaded_chunks == 0;
+}
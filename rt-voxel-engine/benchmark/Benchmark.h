@@ -0,0 +1,92 @@
+#pragma once
+
+#include "game/chunks/ChunkManager.h"
+#include "config.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Shared by benchmark checks, every check lives in its own *Check.cpp and is one entry of CHECKS in ChunkBenchmark.cpp.
+
+const int HEIGHT_CHUNKS = 256;				// chunks per seed for height checks, spread over large area, also negative coordinates
+const float HEIGHT_NOISE_TOLERANCE = 1e-5f;	// batched noise against FastNoiseLite, heights and density lattice
+
+using ChunkHeights = std::array<HeightPayload, CHUNK_SIZE_X * CHUNK_SIZE_Z>;
+
+size_t GetAllocationCount();	// heap allocations of whole process so far, benchmark replaces operator new to count them
+double NsPerItem(std::chrono::high_resolution_clock::duration duration, size_t count);
+glm::ivec2 HeightChunkPosition(int i);	// i < HEIGHT_CHUNKS, scattered
+glm::ivec2 AreaChunkPosition(int i);	// i < HEIGHT_CHUNKS, square around origin, as ChunkManager generates them
+// per column GenerateHeight of every HeightChunkPosition chunk, generator should have noise step 1 to be exact
+void GenerateReferenceHeights(const WorldGenerator& world_generator, std::vector<ChunkHeights>& heights);
+bool SameHeight(const HeightPayload& a, const HeightPayload& b);
+
+// One line JSON object, fields in order they are added. Floating point values are fixed with 1 decimal unless other precision is given.
+class JsonRecord
+{
+public:
+	template <typename T>
+	JsonRecord& Add(const char* name, const T& value)
+	{
+		Key(name);
+		if constexpr (std::is_same_v<T, bool>)
+			stream_ << (value ? "true" : "false");
+		else if constexpr (std::is_floating_point_v<T>)
+			stream_ << std::fixed << std::setprecision(1) << value;
+		else if constexpr (std::is_integral_v<T>)
+			stream_ << value;
+		else
+			stream_ << '"' << value << '"';
+		return *this;
+	}
+	JsonRecord& AddFixed(const char* name, double value, int precision)
+	{
+		Key(name);
+		stream_ << std::fixed << std::setprecision(precision) << value;
+		return *this;
+	}
+	JsonRecord& AddScientific(const char* name, double value)
+	{
+		Key(name);
+		stream_ << std::scientific << std::setprecision(1) << value;
+		return *this;
+	}
+	JsonRecord& AddNull(const char* name)
+	{
+		Key(name);
+		stream_ << "null";
+		return *this;
+	}
+	std::string Str() const { return "{" + stream_.str() + "}"; };
+private:
+	void Key(const char* name)
+	{
+		stream_ << (stream_.tellp() > 0 ? ", \"" : "\"") << name << "\": ";
+	}
+
+	std::ostringstream stream_;
+};
+
+// Check runs for given seeds and adds its JSON records (usually one per seed), false when anything it verifies does not match,
+// benchmark exit code is then 1. Checks which only measure always return true.
+using CheckFunction = bool (*)(const std::vector<int>& seeds, std::vector<std::string>& records);
+
+bool RunAreaCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunHeightCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunColumnCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunClimateCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunContextCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunSplineCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunDensityCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunBakedCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunTreeCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunStorageCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunArenaCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunAoCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunLodCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
+bool RunEditCheck(const std::vector<int>& seeds, std::vector<std::string>& records);
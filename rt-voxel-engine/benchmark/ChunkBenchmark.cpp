@@ -0,0 +1,177 @@
+// Headless benchmark of world generation and meshing, no window, no GPU, no RendererRT.
+// Whole engine chunk code is compiled with HEADLESS define (see CMakeLists.txt in this directory),
+// Chunk::BuildMesh then only builds vertices and remembers their count.
+//
+// Benchmark is table of checks (CHECKS below), each in its own *Check.cpp, described at top of that file. Every check measures
+// and most also verify something. Output is JSON on stdout: config switches ("config"), then "<name>_match" and array of records
+// of every check.
+// Exit code is 1 when any check does not match.
+// Everything but generator contexts check runs on one thread (OpenMP is limited to one), so numbers are comparable between machines
+// with different core count.
+//
+// Usage: ChunkBenchmark [--check name ...] [seed ...]
+//   without seeds SEED from config.h and few fixed ones are used, without --check all checks run, otherwise only named ones
+//   (e.g. --check storage compares block storage backends alone)
+
+#include "Benchmark.h"
+#include "game/chunks/NoiseBatch.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std::chrono;
+
+// every heap allocation of the process is counted, generator contexts check expects none while generating
+static std::atomic<size_t> allocations{ 0 };
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* memory = std::malloc(size != 0 ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+size_t GetAllocationCount()
+{
+	return allocations;
+}
+
+double NsPerItem(high_resolution_clock::duration duration, size_t count)
+{
+	return count == 0 ? 0.0 : (double)duration_cast<nanoseconds>(duration).count() / (double)count;
+}
+
+glm::ivec2 HeightChunkPosition(int i)
+{
+	return glm::ivec2((i % 16) * 397 - 3000, (i / 16) * 211 - 1700);
+}
+
+glm::ivec2 AreaChunkPosition(int i)
+{
+	return glm::ivec2(i % 16 - 8, i / 16 - 8);
+}
+
+void GenerateReferenceHeights(const WorldGenerator& world_generator, std::vector<ChunkHeights>& heights)
+{
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+	{
+		const glm::ivec2 position = HeightChunkPosition(i) * glm::ivec2(CHUNK_SIZE_X, CHUNK_SIZE_Z);
+		for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+			for (int x = 0; x < CHUNK_SIZE_X; ++x)
+				heights[i][x + z * CHUNK_SIZE_X] = world_generator.GenerateHeight(position.x + x, position.y + z);
+	}
+}
+
+bool SameHeight(const HeightPayload& a, const HeightPayload& b)
+{
+	return a.height == b.height && a.should_place_tree == b.should_place_tree && a.continentalness == b.continentalness &&
+		a.erosion == b.erosion && a.peaks_and_valeys == b.peaks_and_valeys;
+}
+
+struct BenchmarkCheck
+{
+	const char* name;	// JSON key of its records
+	CheckFunction run;
+};
+
+static const BenchmarkCheck CHECKS[] =
+{
+	{ "results", RunAreaCheck },
+	{ "heights", RunHeightCheck },
+	{ "columns", RunColumnCheck },
+	{ "climate", RunClimateCheck },
+	{ "contexts", RunContextCheck },
+	{ "splines", RunSplineCheck },
+	{ "density", RunDensityCheck },
+	{ "baked", RunBakedCheck },
+	{ "trees", RunTreeCheck },
+	{ "storage", RunStorageCheck },
+	{ "arena", RunArenaCheck },
+	{ "ao", RunAoCheck },
+	{ "lod", RunLodCheck },
+	{ "edits", RunEditCheck },
+};
+
+int main(int argc, char** argv)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(1);
+#endif
+	std::vector<int> seeds;
+	std::vector<bool> selected(std::size(CHECKS), false);
+	bool any_selected = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--check") != 0)
+		{
+			seeds.push_back(std::atoi(argv[i]));
+			continue;
+		}
+		const char* name = i + 1 < argc ? argv[++i] : "";
+		size_t check = 0;
+		while (check < std::size(CHECKS) && std::strcmp(CHECKS[check].name, name) != 0)
+			++check;
+		if (check == std::size(CHECKS))
+		{
+			std::cerr << "Unknown check: " << name << std::endl;
+			return 2;
+		}
+		selected[check] = any_selected = true;
+	}
+	if (!any_selected)
+		selected.assign(std::size(CHECKS), true);
+	if (seeds.empty())
+		seeds = { SEED, 1, 1337 };
+
+	// all checks run before anything is printed, so printing does not disturb timing
+	std::vector<bool> matches(std::size(CHECKS), true);
+	std::vector<std::vector<std::string>> records(std::size(CHECKS));
+	for (size_t i = 0; i < std::size(CHECKS); ++i)
+		if (selected[i])
+			matches[i] = CHECKS[i].run(seeds, records[i]);
+
+	std::cout << "{" << std::endl;
+	std::cout << "  \"config\": " << JsonRecord()
+		.Add("greedy_meshing", GREEDY_MESHING)
+		.Add("palette_block_storage", PALETTE_BLOCK_STORAGE)
+		.Add("meshing_arena", MESHING_ARENA)
+		.Add("baked_ao", BAKED_AO)
+		.Add("simd_noise", SIMD_NOISE)
+		.Add("coarse_noise_step", COARSE_NOISE_STEP)
+		.Add("spline_lut", SPLINE_LUT)
+		.Add("climate_cache", CLIMATE_CACHE)
+		.Add("density_terrain", DENSITY_TERRAIN)
+		.Add("noise_isa", NoiseBatch::GetIsaName(NoiseBatch::GetIsa()))
+		.Str() << "," << std::endl;
+	bool all_match = true;
+	bool first = true;
+	for (size_t i = 0; i < std::size(CHECKS); ++i)
+	{
+		if (!selected[i])
+			continue;
+		std::cout << (first ? "" : ",\n") << "  \"" << CHECKS[i].name << "_match\": " << (matches[i] ? "true" : "false") << "," << std::endl;
+		std::cout << "  \"" << CHECKS[i].name << "\": [" << std::endl;
+		for (size_t j = 0; j < records[i].size(); ++j)
+			std::cout << "    " << records[i][j] << (j + 1 == records[i].size() ? "" : ",") << std::endl;
+		std::cout << "  ]";
+		all_match = all_match && matches[i];
+		first = false;
+	}
+	std::cout << std::endl << "}" << std::endl;
+	return all_match ? 0 : 1;
+}
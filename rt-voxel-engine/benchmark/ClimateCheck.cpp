@@ -0,0 +1,61 @@
+// Climate cache (CLIMATE_CACHE): heights of render distance 16 area with continentalness and erosion lattice per chunk, and read from
+// ClimateCache regions (cold, regions are built, and warm), ns per chunk. Fails when any height differs, also for per column GenerateHeight.
+
+#include "Benchmark.h"
+using namespace std::chrono;
+
+static const int CLIMATE_RENDER_DISTANCE = 16;
+
+bool RunClimateCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	const int side = 2 * CLIMATE_RENDER_DISTANCE + 1;
+	const size_t chunks = (size_t)side * side;
+	auto generate = [side](const WorldGenerator& world_generator, std::vector<ChunkHeights>& heights)
+	{
+		auto start = high_resolution_clock::now();
+		for (int i = 0; i < side * side; ++i)
+		{
+			const glm::ivec2 position = (glm::ivec2(i % side, i / side) - CLIMATE_RENDER_DISTANCE) * glm::ivec2(CHUNK_SIZE_X, CHUNK_SIZE_Z);
+			world_generator.GenerateHeights(position.x, position.y, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights[i].data());
+		}
+		return NsPerItem(high_resolution_clock::now() - start, heights.size());
+	};
+
+	bool match = true;
+	for (int seed : seeds)
+	{
+		std::vector<ChunkHeights> lattice(chunks), cached(chunks);
+		WorldGenerator lattice_generator(seed);
+		lattice_generator.SetClimateCache(false);
+		const double lattice_ns = generate(lattice_generator, lattice);
+		WorldGenerator world_generator(seed);
+		world_generator.SetClimateCache(true);
+		const double cold_ns = generate(world_generator, cached);
+		const double warm_ns = generate(world_generator, cached);
+
+		size_t height_mismatches = 0;	// against lattice per chunk, batched and per column
+		for (int i = 0; i < side * side; ++i)
+			for (int column = 0; column < CHUNK_SIZE_X * CHUNK_SIZE_Z; ++column)
+				height_mismatches += !SameHeight(lattice[i][column], cached[i][column]);
+		// per column, one row of chunks is enough, it crosses all region borders along x
+		for (int i = 0; i < side; ++i)
+			for (int column = 0; column < CHUNK_SIZE_X * CHUNK_SIZE_Z; ++column)
+			{
+				const int x = (i - CLIMATE_RENDER_DISTANCE) * CHUNK_SIZE_X + column % CHUNK_SIZE_X;
+				const int z = -CLIMATE_RENDER_DISTANCE * CHUNK_SIZE_Z + column / CHUNK_SIZE_X;
+				height_mismatches += !SameHeight(lattice[i][column], world_generator.GenerateHeight(x, z));
+			}
+
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("chunks", chunks)
+			.Add("lattice_ns_per_chunk", lattice_ns)
+			.Add("cold_ns_per_chunk", cold_ns)
+			.Add("warm_ns_per_chunk", warm_ns)
+			.Add("regions_built", world_generator.GetClimateRegionBuilds())
+			.Add("height_mismatches", height_mismatches)
+			.Str());
+		match = match && height_mismatches == 0;
+	}
+	return match;
+}
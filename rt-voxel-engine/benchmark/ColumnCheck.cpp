@@ -0,0 +1,60 @@
+// Column fill in ns per chunk: WorldGenerator::GetBlockType for every block against GetColumnSpans applied as runs, both into plain
+// array (section layout, column + y * columns). Fails when they give different blocks.
+
+#include "Benchmark.h"
+#include <algorithm>
+using namespace std::chrono;
+
+bool RunColumnCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+	{
+		WorldGenerator world_generator(seed);
+		world_generator.SetNoiseStep(1);
+		world_generator.SetClimateCache(false);
+		std::vector<ChunkHeights> heights(HEIGHT_CHUNKS);
+		GenerateReferenceHeights(world_generator, heights);
+
+		// one chunk after another into the same array
+		const int columns = CHUNK_SIZE_X * CHUNK_SIZE_Z;
+		std::vector<BlockId> per_block((size_t)HEIGHT_CHUNKS * CHUNK_VOLUME), spans((size_t)HEIGHT_CHUNKS * CHUNK_VOLUME);
+		auto start = high_resolution_clock::now();
+		for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		{
+			BlockId* blocks = &per_block[(size_t)i * CHUNK_VOLUME];
+			for (int column = 0; column < columns; ++column)
+				for (int y = 0; y < CHUNK_SIZE_Y; ++y)
+					blocks[column + y * columns] = world_generator.GetBlockType(column % CHUNK_SIZE_X, y, column / CHUNK_SIZE_X, heights[i][column]);
+		}
+		const double per_block_ns = NsPerItem(high_resolution_clock::now() - start, HEIGHT_CHUNKS);
+
+		start = high_resolution_clock::now();
+		std::fill(spans.begin(), spans.end(), BlockId::Air);
+		for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		{
+			BlockId* blocks = &spans[(size_t)i * CHUNK_VOLUME];
+			std::array<BlockSpan, MAX_COLUMN_SPANS> column_spans;
+			for (int column = 0; column < columns; ++column)
+			{
+				const int count = world_generator.GetColumnSpans(heights[i][column], column_spans.data());
+				for (int span = 0; span < count; ++span)
+					for (int y = column_spans[span].y_begin; y < std::min(column_spans[span].y_end, CHUNK_SIZE_Y); ++y)
+						blocks[column + y * columns] = column_spans[span].block;
+			}
+		}
+		const double spans_ns = NsPerItem(high_resolution_clock::now() - start, HEIGHT_CHUNKS);
+
+		size_t block_mismatches = 0;
+		for (size_t i = 0; i < per_block.size(); ++i)
+			block_mismatches += per_block[i] != spans[i];
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("per_block_ns_per_chunk", per_block_ns)
+			.Add("spans_ns_per_chunk", spans_ns)
+			.Add("block_mismatches", block_mismatches)
+			.Str());
+		match = match && block_mismatches == 0;
+	}
+	return match;
+}
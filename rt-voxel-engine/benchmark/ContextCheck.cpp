@@ -0,0 +1,80 @@
+// Generator contexts: heights and column spans of square area of chunks generated on all cores at once (the only multithreaded check),
+// one shared WorldGenerator and GenerationContext per thread, ns per chunk is wall time of all threads together.
+// Fails when any heap allocation happens meanwhile or result differs from single thread.
+
+#include "Benchmark.h"
+#include "game/chunks/GenerationContext.h"
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std::chrono;
+
+static const int CONTEXT_MIN_THREADS = 4;	// threads share generator even on small machines
+
+static bool RunContexts(int seed, std::vector<std::string>& records)
+{
+	const WorldGenerator world_generator(seed);
+	const int columns = CHUNK_SIZE_X * CHUNK_SIZE_Z;
+	std::vector<ChunkHeights> expected(HEIGHT_CHUNKS), heights(HEIGHT_CHUNKS);
+	std::vector<BlockSpan> expected_spans((size_t)HEIGHT_CHUNKS * columns * MAX_COLUMN_SPANS), spans(expected_spans.size());
+	auto generate = [&world_generator](int i, GenerationContext& context, ChunkHeights& heights, BlockSpan* spans)
+	{
+		const glm::ivec2 position = AreaChunkPosition(i) * glm::ivec2(CHUNK_SIZE_X, CHUNK_SIZE_Z);
+		world_generator.GenerateHeights(position.x, position.y, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights.data(), context);
+		for (int column = 0; column < columns; ++column)
+			world_generator.GetColumnSpans(heights[column], spans + column * MAX_COLUMN_SPANS);
+	};
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		generate(i, GenerationContext::ForCurrentThread(), expected[i], &expected_spans[(size_t)i * columns * MAX_COLUMN_SPANS]);
+
+	int threads = 1;
+#ifdef _OPENMP
+	threads = std::max(omp_get_num_procs(), CONTEXT_MIN_THREADS);
+	// contexts are created on first use, that is the only allocation thread does
+#pragma omp parallel num_threads(threads)
+	GenerationContext::ForCurrentThread();
+#endif
+	const size_t allocations_before = GetAllocationCount();
+	auto start = high_resolution_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		generate(i, GenerationContext::ForCurrentThread(), heights[i], &spans[(size_t)i * columns * MAX_COLUMN_SPANS]);
+	const double ns = NsPerItem(high_resolution_clock::now() - start, HEIGHT_CHUNKS);
+	const size_t allocations = GetAllocationCount() - allocations_before;
+
+	size_t mismatches = 0;	// columns different from single thread
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		for (int column = 0; column < columns; ++column)
+		{
+			const HeightPayload& a = expected[i][column];
+			bool same = SameHeight(a, heights[i][column]);
+			const size_t first_span = ((size_t)i * columns + column) * MAX_COLUMN_SPANS;
+			for (int span = 0; span < world_generator.GetColumnSpans(a, &expected_spans[first_span]); ++span)
+			{
+				const BlockSpan& c = expected_spans[first_span + span];
+				const BlockSpan& d = spans[first_span + span];
+				same = same && c.block == d.block && c.y_begin == d.y_begin && c.y_end == d.y_end;
+			}
+			mismatches += !same;
+		}
+
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("threads", threads)
+		.Add("ns_per_chunk", ns)
+		.Add("allocations", allocations)
+		.Add("mismatches", mismatches)
+		.Str());
+	return allocations == 0 && mismatches == 0;
+}
+
+bool RunContextCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+		match = RunContexts(seed, records) && match;
+	return match;
+}
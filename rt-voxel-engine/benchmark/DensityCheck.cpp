@@ -0,0 +1,150 @@
+// Density terrain (DENSITY_TERRAIN): generate cost of the same area (centered on land, above sea only density can add overhangs)
+// with heightmap only and with density (fastest of DENSITY_PASSES), NoiseBatch 3D lattice with
+// every noise ISA against FastNoiseLite at lattice points, and carving and raising (lattice interpolated, sections skipped by lattice
+// bounds) against exact GetDensity at every carvable and raisable block, overhangs are raised blocks with air right under them.
+// Fails when lattice differs by more than HEIGHT_NOISE_TOLERANCE, or more than DENSITY_MAX_CARVE_MISMATCH of carvable or raisable
+// blocks are shaped differently.
+
+#include "Benchmark.h"
+#include "game/chunks/NoiseBatch.h"
+#include <algorithm>
+#include <cmath>
+using namespace std::chrono;
+
+static const int DENSITY_RENDER_DISTANCE = 8;
+static const int DENSITY_LATTICE_CHUNKS = 64;
+static const int DENSITY_PASSES = 3;
+static const double DENSITY_MAX_CARVE_MISMATCH = 0.03;	// fraction of carvable blocks, lattice is only approximation of density
+
+// highest of scattered height chunks by mean column height
+static glm::ivec2 LandCenter(int seed)
+{
+	const WorldGenerator world_generator(seed);
+	ChunkHeights heights;
+	glm::ivec2 center(0, 0);
+	long long int highest = -1;
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+	{
+		const glm::ivec2 position = HeightChunkPosition(i);
+		world_generator.GenerateHeights(position.x * CHUNK_SIZE_X, position.y * CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights.data());
+		long long int height = 0;
+		for (const HeightPayload& column : heights)
+			height += column.height;
+		if (height > highest)
+		{
+			highest = height;
+			center = position;
+		}
+	}
+	return center;
+}
+
+static bool RunDensity(int seed, std::vector<std::string>& records)
+{
+	double heightmap_ns = 0.0, density_ns = 0.0;	// per chunk, generate same as in area check, fastest of DENSITY_PASSES
+	size_t carvable_blocks = 0, carved_blocks = 0, carve_mismatches = 0;
+	size_t raisable_blocks = 0, raised_blocks = 0, raise_mismatches = 0, overhang_blocks = 0;
+	const glm::ivec2 center = LandCenter(seed);
+	const glm::vec3 start_position((center.x + 0.5f) * CHUNK_SIZE_X, 140.0f, (center.y + 0.5f) * CHUNK_SIZE_Z);
+	// both ways in every pass, so they share the same machine noise, blocks are checked once
+	for (int pass = 0; pass < DENSITY_PASSES; ++pass)
+		for (bool density : { false, true })
+		{
+			ChunkManager chunk_manager(DENSITY_RENDER_DISTANCE, start_position, seed);
+			chunk_manager.GetWorldGenerator().SetDensityTerrain(density);
+			auto start = high_resolution_clock::now();
+			chunk_manager.GenerateArea(center.x, center.y, DENSITY_RENDER_DISTANCE);
+			const double ns = NsPerItem(high_resolution_clock::now() - start, chunk_manager.GetChunkCount());
+			double& fastest_ns = density ? density_ns : heightmap_ns;
+			fastest_ns = pass == 0 ? ns : std::min(fastest_ns, ns);
+			if (!density || pass > 0)
+				continue;
+
+			const WorldGenerator& world_generator = chunk_manager.GetWorldGenerator();
+			ChunkHeights heights;
+			for (int chunk_z = center.y - DENSITY_RENDER_DISTANCE; chunk_z <= center.y + DENSITY_RENDER_DISTANCE; ++chunk_z)
+				for (int chunk_x = center.x - DENSITY_RENDER_DISTANCE; chunk_x <= center.x + DENSITY_RENDER_DISTANCE; ++chunk_x)
+				{
+					const Chunk* chunk = chunk_manager.FindChunk(chunk_x, chunk_z);
+					const int world_x = chunk_x * CHUNK_SIZE_X, world_z = chunk_z * CHUNK_SIZE_Z;
+					world_generator.GenerateHeights(world_x, world_z, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights.data());
+					for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+						for (int x = 0; x < CHUNK_SIZE_X; ++x)
+						{
+							const HeightPayload& height = heights[x + z * CHUNK_SIZE_X];
+							for (int y = 0; y < CHUNK_SIZE_Y; ++y)
+							{
+								if (world_generator.IsRaisable(y, height))
+								{
+									// trees grow into air above column top, but never place stone
+									const bool raised = chunk->GetBlock(x, y, z) == BlockId::Stone;
+									++raisable_blocks;
+									raised_blocks += raised;
+									overhang_blocks += raised && chunk->GetBlock(x, y - 1, z) == BlockId::Air;
+									raise_mismatches += raised !=
+										(world_generator.GetDensity(world_x + x, y, world_z + z, height) > world_generator.GetOverhangThreshold());
+								}
+								if (!world_generator.IsCarvable(y, height))
+									continue;
+								const bool carved = chunk->GetBlock(x, y, z) == BlockId::Air;
+								++carvable_blocks;
+								carved_blocks += carved;
+								carve_mismatches += carved != (world_generator.GetDensity(world_x + x, y, world_z + z, height) < 0.0f);
+							}
+						}
+				}
+		}
+
+	const WorldGenerator world_generator(seed);
+	const int size_x = CHUNK_SIZE_X / DENSITY_STEP_XZ + 1, size_y = CHUNK_SIZE_Y / DENSITY_STEP_Y + 1, size_z = CHUNK_SIZE_Z / DENSITY_STEP_XZ + 1;
+	std::vector<float> overhang(size_x * size_y * size_z), cave(size_x * size_y * size_z);
+	float lattice_max_error = 0.0f;	// all noise ISAs
+	const NoiseBatch::Isa best_isa = NoiseBatch::GetIsa();
+	for (NoiseBatch::Isa isa : { NoiseBatch::Isa::Scalar, NoiseBatch::Isa::SSE41, NoiseBatch::Isa::AVX2 })
+	{
+		if (isa > best_isa)
+			break;
+		NoiseBatch::SetIsa(isa);
+		for (int i = 0; i < DENSITY_LATTICE_CHUNKS; ++i)
+		{
+			const glm::ivec2 position = HeightChunkPosition(i) * glm::ivec2(CHUNK_SIZE_X, CHUNK_SIZE_Z);
+			world_generator.GenerateDensityLattice(position.x, position.y, size_x, size_y, size_z, overhang.data(), cave.data());
+			for (int z = 0; z < size_z; ++z)
+				for (int x = 0; x < size_x; ++x)
+					for (int y = 0; y < size_y; ++y)
+					{
+						const int i = y + size_y * (x + size_x * z);
+						const int world_x = position.x + x * DENSITY_STEP_XZ, world_y = y * DENSITY_STEP_Y, world_z = position.y + z * DENSITY_STEP_XZ;
+						lattice_max_error = std::max({ lattice_max_error,
+							std::abs(overhang[i] - world_generator.GetDensityNoise(DensityNoise::Overhang, world_x, world_y, world_z)),
+							std::abs(cave[i] - world_generator.GetDensityNoise(DensityNoise::Cave, world_x, world_y, world_z)) });
+					}
+		}
+	}
+	NoiseBatch::SetIsa(best_isa);
+
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("heightmap_generate_ns_per_chunk", heightmap_ns)
+		.Add("density_generate_ns_per_chunk", density_ns)
+		.AddFixed("cost_ratio", density_ns / heightmap_ns, 2)
+		.AddScientific("lattice_max_error", lattice_max_error)
+		.Add("carvable_blocks", carvable_blocks)
+		.Add("carved_blocks", carved_blocks)
+		.Add("carve_mismatches", carve_mismatches)
+		.Add("raisable_blocks", raisable_blocks)
+		.Add("raised_blocks", raised_blocks)
+		.Add("overhang_blocks", overhang_blocks)
+		.Add("raise_mismatches", raise_mismatches)
+		.Str());
+	return lattice_max_error <= HEIGHT_NOISE_TOLERANCE && carve_mismatches <= DENSITY_MAX_CARVE_MISMATCH * carvable_blocks &&
+		raise_mismatches <= DENSITY_MAX_CARVE_MISMATCH * raisable_blocks;
+}
+
+bool RunDensityCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+		match = RunDensity(seed, records) && match;
+	return match;
+}
@@ -0,0 +1,74 @@
+// Block edits (EDIT_CACHE_DISTANCE): single ChunkManager::SetBlock followed by UpdateDirtyChunks, first edit of every chunk within
+// edit cache distance of origin, with section cache of edit area and without any (every chunk meshes whole itself into cache on
+// its first edit, as chunks outside edit area do), ns per edit of each. Interior edit dirties one section, border edit also
+// one section of neighbour (edited chunks are two apart, so every neighbour is edited only once).
+// Fails when any chunk in the area has different vertex count than full BuildMesh of it after edits.
+
+#include "Benchmark.h"
+using namespace std::chrono;
+
+static const int EDIT_RENDER_DISTANCE = EDIT_CACHE_DISTANCE + 1;
+static const int EDIT_COLUMN = CHUNK_SIZE_Z / 2;	// z of edited column, x is middle of chunk (interior) or 0 (border)
+
+static bool RunEdit(int seed, bool border, bool section_cache, std::vector<std::string>& records)
+{
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);
+	ChunkManager chunk_manager(EDIT_RENDER_DISTANCE, start_position, seed);
+	chunk_manager.SetEditCacheDistance(section_cache ? EDIT_CACHE_DISTANCE : -1);
+	chunk_manager.GenerateArea(0, 0, EDIT_RENDER_DISTANCE);
+
+	std::vector<Chunk*> rendered;
+	for (int z = -EDIT_RENDER_DISTANCE; z <= EDIT_RENDER_DISTANCE; ++z)
+		for (int x = -EDIT_RENDER_DISTANCE; x <= EDIT_RENDER_DISTANCE; ++x)
+		{
+			rendered.push_back(chunk_manager.FindChunk(x, z));
+			rendered.back()->BuildMesh(chunk_manager.GetLod(x, z));
+		}
+
+	// stone on top of column
+	size_t edits = 0;
+	high_resolution_clock::duration edit_time{};
+	for (int z = -EDIT_CACHE_DISTANCE; z <= EDIT_CACHE_DISTANCE; ++z)
+		for (int x = -EDIT_CACHE_DISTANCE; x <= EDIT_CACHE_DISTANCE; ++x)
+		{
+			if (border && (x & 1) == 0)
+				continue;	// neighbour on the left is odd one
+			const int x_local = border ? 0 : CHUNK_SIZE_X / 2;
+			const int y = chunk_manager.FindChunk(x, z)->GetHeightSummary().heightmap[x_local + EDIT_COLUMN * CHUNK_SIZE_X] + 1;
+			if (y >= CHUNK_SIZE_Y)
+				continue;
+			auto start = high_resolution_clock::now();
+			chunk_manager.SetBlock((long long int)x * CHUNK_SIZE_X + x_local, y, (long long int)z * CHUNK_SIZE_Z + EDIT_COLUMN, BlockId::Stone);
+			chunk_manager.UpdateDirtyChunks();
+			edit_time += high_resolution_clock::now() - start;
+			++edits;
+		}
+
+	size_t vertex_mismatches = 0;
+	for (Chunk* chunk : rendered)
+	{
+		const size_t edited_vertices = chunk->GetVertexCount();
+		chunk->BuildMesh(chunk->GetLod());
+		vertex_mismatches += chunk->GetVertexCount() != edited_vertices;
+	}
+
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("edit", border ? "border" : "interior")
+		.Add("section_cache", section_cache)
+		.Add("edits", edits)
+		.Add("ns_per_edit", NsPerItem(edit_time, edits))
+		.Add("vertex_mismatches", vertex_mismatches)
+		.Str());
+	return vertex_mismatches == 0;
+}
+
+bool RunEditCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+		for (bool border : { false, true })
+			for (bool section_cache : { false, true })
+				match = RunEdit(seed, border, section_cache, records) && match;
+	return match;
+}
@@ -0,0 +1,95 @@
+// Column heights: WorldGenerator::GenerateHeights with every noise ISA supported by CPU against per column GenerateHeight (reference),
+// and coarse noise (COARSE_NOISE_STEP) against exact one, ns per chunk. Fails when exact batched noise differs by more than
+// HEIGHT_NOISE_TOLERANCE, or coarse terrain height by more than COARSE_NOISE_MAX_HEIGHT_ERROR blocks.
+// Scattered chunks would each need its own ClimateCache region, so climate cache is off here (it has its own check).
+
+#include "Benchmark.h"
+#include "game/chunks/NoiseBatch.h"
+#include <algorithm>
+#include <cmath>
+using namespace std::chrono;
+
+static const int COARSE_NOISE_MAX_HEIGHT_ERROR = 2;
+
+static bool RunBatchedHeights(const WorldGenerator& world_generator, int seed, const std::vector<ChunkHeights>& reference,
+	std::vector<std::string>& records)
+{
+	std::vector<ChunkHeights> batched(HEIGHT_CHUNKS);
+	auto start = high_resolution_clock::now();
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+	{
+		const glm::ivec2 position = HeightChunkPosition(i) * glm::ivec2(CHUNK_SIZE_X, CHUNK_SIZE_Z);
+		world_generator.GenerateHeights(position.x, position.y, CHUNK_SIZE_X, CHUNK_SIZE_Z, batched[i].data());
+	}
+	const double ns = NsPerItem(high_resolution_clock::now() - start, HEIGHT_CHUNKS);
+
+	float max_error = 0.0f;	// of noise channels against reference
+	size_t height_mismatches = 0;
+	int max_height_error = 0;
+	double mean_height_error = 0.0;
+	for (int i = 0; i < HEIGHT_CHUNKS; ++i)
+		for (size_t column = 0; column < reference[i].size(); ++column)
+		{
+			const HeightPayload& expected = reference[i][column];
+			const HeightPayload& actual = batched[i][column];
+			max_error = std::max({ max_error, std::abs(expected.continentalness - actual.continentalness),
+				std::abs(expected.erosion - actual.erosion), std::abs(expected.peaks_and_valeys - actual.peaks_and_valeys) });
+			if (expected.height != actual.height || expected.should_place_tree != actual.should_place_tree)
+				++height_mismatches;
+			max_height_error = std::max(max_height_error, std::abs(expected.height - actual.height));
+			mean_height_error += std::abs(expected.height - actual.height);
+		}
+	mean_height_error /= (double)HEIGHT_CHUNKS * CHUNK_SIZE_X * CHUNK_SIZE_Z;
+
+	const int noise_step = world_generator.GetNoiseStep();
+	records.push_back(JsonRecord()
+		.Add("seed", seed)
+		.Add("isa", NoiseBatch::GetIsaName(NoiseBatch::GetIsa()))
+		.Add("noise_step", noise_step)
+		.Add("ns_per_chunk", ns)
+		.AddScientific("max_error", max_error)
+		.Add("height_mismatches", height_mismatches)
+		.Add("max_height_error", max_height_error)
+		.AddFixed("mean_height_error", mean_height_error, 4)
+		.Str());
+	if (noise_step > 1)
+		return max_height_error <= COARSE_NOISE_MAX_HEIGHT_ERROR;
+	return max_error <= HEIGHT_NOISE_TOLERANCE && height_mismatches == 0;
+}
+
+bool RunHeightCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (int seed : seeds)
+	{
+		WorldGenerator world_generator(seed);
+		world_generator.SetNoiseStep(1);
+		world_generator.SetClimateCache(false);
+		std::vector<ChunkHeights> reference(HEIGHT_CHUNKS);
+		auto start = high_resolution_clock::now();
+		GenerateReferenceHeights(world_generator, reference);
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("isa", "reference")
+			.Add("noise_step", 1)
+			.Add("ns_per_chunk", NsPerItem(high_resolution_clock::now() - start, HEIGHT_CHUNKS))
+			.Str());
+
+		const NoiseBatch::Isa best_isa = NoiseBatch::GetIsa();
+		for (NoiseBatch::Isa isa : { NoiseBatch::Isa::Scalar, NoiseBatch::Isa::SSE41, NoiseBatch::Isa::AVX2 })
+		{
+			if (isa > best_isa)
+				break;
+			NoiseBatch::SetIsa(isa);
+			match = RunBatchedHeights(world_generator, seed, reference, records) && match;
+		}
+		NoiseBatch::SetIsa(best_isa);
+
+		if (COARSE_NOISE_STEP > 1)
+		{
+			world_generator.SetNoiseStep(COARSE_NOISE_STEP);
+			match = RunBatchedHeights(world_generator, seed, reference, records) && match;
+		}
+	}
+	return match;
+}
@@ -0,0 +1,61 @@
+// LOD meshing (LOD_MESHING): patch of chunks across each LOD ring border (LOD_RING_* in config.h, player chunk at origin), every chunk
+// meshed in full detail and then with its ring LOD, record per seed and LOD has triangles of both, skirted_sides are chunk sides
+// towards other LOD (only those get skirts). Only measures, it never fails.
+
+#include "Benchmark.h"
+#include <map>
+using namespace std::chrono;
+
+static const int LOD_PATCH_RADIUS = 2;	// patch is 5 x 5 chunks, centered on ring border, so both LODs are in it
+
+struct LodTriangles
+{
+	size_t chunks = 0;
+	size_t skirted_sides = 0;
+	size_t triangles = 0;
+	size_t full_detail_triangles = 0;
+};
+
+static void RunLod(int seed, std::vector<std::string>& records)
+{
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);
+	ChunkManager chunk_manager(LOD_PATCH_RADIUS, start_position, seed);
+
+	std::map<int, LodTriangles> rings;
+	for (int ring : { LOD_RING_2X, LOD_RING_4X, LOD_RING_8X })
+	{
+		chunk_manager.GenerateArea(ring, 0, LOD_PATCH_RADIUS);
+		for (int z = -LOD_PATCH_RADIUS; z <= LOD_PATCH_RADIUS; ++z)
+			for (int x = ring - LOD_PATCH_RADIUS; x <= ring + LOD_PATCH_RADIUS; ++x)
+			{
+				Chunk* chunk = chunk_manager.FindChunk(x, z);
+				const int lod = chunk_manager.GetLod(x, z);
+				LodTriangles& triangles = rings[lod];
+				chunk->BuildMesh(1);
+				triangles.full_detail_triangles += chunk->GetVertexCount() / 2;	// 4 vertices per quad
+				chunk->BuildMesh(lod);
+				triangles.triangles += chunk->GetVertexCount() / 2;
+				++triangles.chunks;
+				for (const glm::ivec2& side : { glm::ivec2(-1, 0), glm::ivec2(1, 0), glm::ivec2(0, -1), glm::ivec2(0, 1) })
+					triangles.skirted_sides += chunk_manager.GetLod(x + side.x, z + side.y) != lod;
+			}
+	}
+
+	for (const auto& [lod, triangles] : rings)
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("lod", lod)
+			.Add("chunks", triangles.chunks)
+			.Add("skirted_sides", triangles.skirted_sides)
+			.Add("triangles", triangles.triangles)
+			.Add("full_detail_triangles", triangles.full_detail_triangles)
+			.AddFixed("triangle_ratio", (double)triangles.triangles / triangles.full_detail_triangles, 3)
+			.Str());
+}
+
+bool RunLodCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	for (int seed : seeds)
+		RunLod(seed, records);
+	return true;
+}
@@ -0,0 +1,60 @@
+// Terrain splines in ns per sample: cosine interpolation, SplineTable one by one and batched, generator of first seed (splines do not
+// depend on seed). Fails when table differs from cosine spline by more than SPLINE_TABLE_TOLERANCE.
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+using namespace std::chrono;
+
+static const int SPLINE_SAMPLES = 1 << 20;
+static const float SPLINE_TABLE_TOLERANCE = 0.01f;	// in blocks (or erosion multiplier)
+
+static bool RunSpline(const WorldGenerator& world_generator, TerrainSpline spline, const char* name, std::vector<std::string>& records)
+{
+	// inputs also out of control points range, noise can get there
+	std::vector<float> inputs(SPLINE_SAMPLES);
+	uint32_t random = 12345;
+	for (float& input : inputs)
+	{
+		random = random * 1664525u + 1013904223u;
+		input = (random >> 8) / float(1 << 24) * 2.2f - 1.1f;
+	}
+	std::vector<float> cosine(SPLINE_SAMPLES), table(SPLINE_SAMPLES), table_batch(SPLINE_SAMPLES);
+	const SplineTable& spline_table = world_generator.GetSplineTable(spline);
+
+	auto start = high_resolution_clock::now();
+	for (int i = 0; i < SPLINE_SAMPLES; ++i)
+		cosine[i] = world_generator.EvaluateSpline(spline, inputs[i]);
+	const double cosine_ns = NsPerItem(high_resolution_clock::now() - start, SPLINE_SAMPLES);
+
+	start = high_resolution_clock::now();
+	for (int i = 0; i < SPLINE_SAMPLES; ++i)
+		table[i] = spline_table.Evaluate(inputs[i]);
+	const double table_ns = NsPerItem(high_resolution_clock::now() - start, SPLINE_SAMPLES);
+
+	start = high_resolution_clock::now();
+	spline_table.Evaluate(inputs.data(), table_batch.data(), SPLINE_SAMPLES);
+	const double table_batch_ns = NsPerItem(high_resolution_clock::now() - start, SPLINE_SAMPLES);
+
+	float max_error = 0.0f;
+	for (int i = 0; i < SPLINE_SAMPLES; ++i)
+		max_error = std::max({ max_error, std::abs(cosine[i] - table[i]), std::abs(cosine[i] - table_batch[i]) });
+
+	records.push_back(JsonRecord()
+		.Add("spline", name)
+		.AddFixed("cosine_ns_per_sample", cosine_ns, 2)
+		.AddFixed("table_ns_per_sample", table_ns, 2)
+		.AddFixed("table_batch_ns_per_sample", table_batch_ns, 2)
+		.AddScientific("max_error", max_error)
+		.Str());
+	return max_error <= SPLINE_TABLE_TOLERANCE;
+}
+
+bool RunSplineCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	const WorldGenerator world_generator(seeds.front());
+	bool match = RunSpline(world_generator, TerrainSpline::Continentalness, "continentalness", records);
+	match = RunSpline(world_generator, TerrainSpline::Erosion, "erosion", records) && match;
+	match = RunSpline(world_generator, TerrainSpline::PeaksAndValeys, "peaks_and_valeys", records) && match;
+	return match;
+}
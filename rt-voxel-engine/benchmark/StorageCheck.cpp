@@ -0,0 +1,141 @@
+// Block storage backends side by side (PALETTE_BLOCK_STORAGE), first seed, render area of STORAGE_RENDER_DISTANCE:
+// blocks of every generated section are copied into FlatBlockStorage and into PaletteBlockStorage, record per backend has
+//   storage_memory  - MemoryUsage of all sections of render area
+//   chunks_memory   - Chunk::MemoryUsage of render area with section storage of that backend
+//   capture_ns      - per chunk, section reads of ChunkSnapshot::Capture (row by row, empty sections skipped), only part of
+//                     Chunk::BuildMesh touching storage, mesher itself works on snapshot
+//   build_mesh_ns   - per chunk, Chunk::BuildMesh (compiled backend, "compiled" is true) with its capture_ns swapped for this one
+// Storage backend is compile time type of ChunkSection, so only compiled one can be meshed directly.
+// Fails when any block of either copy differs from chunk.
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+using namespace std::chrono;
+
+static const int STORAGE_RENDER_DISTANCE = 8;
+static const int STORAGE_CAPTURE_REPEATS = 4;	// reads are short, repeated so timer resolution does not matter
+
+// reads same cells in same order as ChunkSnapshot::Capture, sum of non air keeps the loop alive
+template <typename Storage>
+static uint64_t CaptureStorages(const std::vector<Storage>& storages, const std::vector<SectionState>& states)
+{
+	uint64_t non_air = 0;
+	for (size_t i = 0; i < storages.size(); ++i)
+	{
+		if (states[i] == SectionState::Empty)
+			continue;
+		for (int y = 0; y < SECTION_SIZE; ++y)
+			for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+			{
+				const int section_index = z * CHUNK_SIZE_X + y * (CHUNK_SIZE_X * CHUNK_SIZE_Z);
+				for (int x = 0; x < CHUNK_SIZE_X; ++x)
+					non_air += storages[i].Get(section_index + x) != BlockId::Air;
+			}
+	}
+	return non_air;
+}
+
+template <typename Storage>
+static double CaptureNs(const std::vector<Storage>& storages, const std::vector<SectionState>& states, size_t chunks, uint64_t& checksum)
+{
+	auto start = high_resolution_clock::now();
+	for (int repeat = 0; repeat < STORAGE_CAPTURE_REPEATS; ++repeat)
+		checksum += CaptureStorages(storages, states);
+	return NsPerItem(high_resolution_clock::now() - start, chunks * STORAGE_CAPTURE_REPEATS);
+}
+
+template <typename Storage>
+static size_t MemoryUsage(const std::vector<Storage>& storages)
+{
+	size_t memory = 0;
+	for (const Storage& storage : storages)
+		memory += storage.MemoryUsage();
+	return memory;
+}
+
+template <typename Storage>
+static size_t Mismatches(const std::vector<Storage>& storages, const std::vector<Chunk*>& rendered)
+{
+	size_t mismatches = 0;
+	for (size_t i = 0; i < storages.size(); ++i)
+	{
+		const ChunkSection& section = rendered[i / CHUNK_SECTION_COUNT]->GetSection(i % CHUNK_SECTION_COUNT);
+		for (int index = 0; index < SECTION_VOLUME; ++index)
+			mismatches += storages[i].Get(index) != section.GetBlock(index);
+	}
+	return mismatches;
+}
+
+bool RunStorageCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	const int seed = seeds.front();
+	const glm::vec3 start_position(8.0f, 140.0f, 8.0f);
+	ChunkManager chunk_manager(STORAGE_RENDER_DISTANCE, start_position, seed);
+	chunk_manager.GenerateArea(0, 0, STORAGE_RENDER_DISTANCE);
+
+	std::vector<Chunk*> rendered;
+	for (int z = -STORAGE_RENDER_DISTANCE; z <= STORAGE_RENDER_DISTANCE; ++z)
+		for (int x = -STORAGE_RENDER_DISTANCE; x <= STORAGE_RENDER_DISTANCE; ++x)
+			rendered.push_back(chunk_manager.FindChunk(x, z));
+
+	// copies of every section of render area, chunk after chunk
+	std::vector<FlatBlockStorage> flat;
+	std::vector<PaletteBlockStorage> palette;
+	std::vector<SectionState> states;
+	std::vector<BlockId> blocks(SECTION_VOLUME);
+	for (const Chunk* chunk : rendered)
+		for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+		{
+			const ChunkSection& section = chunk->GetSection(section_y);
+			for (int index = 0; index < SECTION_VOLUME; ++index)
+				blocks[index] = section.GetBlock(index);
+			flat.emplace_back(SECTION_VOLUME).Assign(blocks.data());
+			palette.emplace_back(SECTION_VOLUME).Assign(blocks.data());
+			states.push_back(section.GetState());
+		}
+	size_t chunks_memory = 0;
+	for (const Chunk* chunk : rendered)
+		chunks_memory += chunk->MemoryUsage();
+
+	// same lod as area check
+	auto start = high_resolution_clock::now();
+	for (Chunk* chunk : rendered)
+	{
+		const glm::i64vec3 position = chunk->GetGlobalPosition();
+		const long long int distance = std::max(std::abs(position.x), std::abs(position.z));
+		int lod = 1;
+		if (LOD_MESHING)
+			lod = distance >= LOD_RING_8X ? 8 : distance >= LOD_RING_4X ? 4 : distance >= LOD_RING_2X ? 2 : 1;
+		chunk->BuildMesh(lod);
+	}
+	const double build_mesh_ns = NsPerItem(high_resolution_clock::now() - start, rendered.size());
+
+	uint64_t flat_checksum = 0, palette_checksum = 0;
+	const double flat_capture_ns = CaptureNs(flat, states, rendered.size(), flat_checksum);
+	const double palette_capture_ns = CaptureNs(palette, states, rendered.size(), palette_checksum);
+	const double compiled_capture_ns = PALETTE_BLOCK_STORAGE ? palette_capture_ns : flat_capture_ns;
+	const size_t flat_memory = MemoryUsage(flat), palette_memory = MemoryUsage(palette);
+	const size_t compiled_memory = PALETTE_BLOCK_STORAGE ? palette_memory : flat_memory;
+	const size_t chunk_rest = chunks_memory - compiled_memory;	// everything but section storage
+	const size_t flat_mismatches = Mismatches(flat, rendered), palette_mismatches = Mismatches(palette, rendered);
+
+	const auto record = [&](const char* storage, bool compiled, size_t memory, double capture_ns, uint64_t checksum, size_t mismatches)
+	{
+		records.push_back(JsonRecord()
+			.Add("seed", seed)
+			.Add("storage", storage)
+			.Add("compiled", compiled)
+			.Add("meshed_chunks", rendered.size())
+			.Add("storage_memory", memory)
+			.Add("chunks_memory", chunk_rest + memory)
+			.Add("capture_ns_per_chunk", capture_ns)
+			.Add("build_mesh_ns_per_chunk", build_mesh_ns - compiled_capture_ns + capture_ns)
+			.Add("block_mismatches", mismatches)
+			.Add("checksum", checksum)
+			.Str());
+	};
+	record("flat", !PALETTE_BLOCK_STORAGE, flat_memory, flat_capture_ns, flat_checksum, flat_mismatches);
+	record("palette", PALETTE_BLOCK_STORAGE, palette_memory, palette_capture_ns, palette_checksum, palette_mismatches);
+	return flat_mismatches == 0 && palette_mismatches == 0;
+}
@@ -0,0 +1,80 @@
+// Tree columns (WorldGenerator::ShouldPlaceTree) of fixed area are hashed and compared with TREE_GOLDEN, saved worlds rely on them,
+// so check fails when they change. New golden values are needed only when tree placement is changed on purpose.
+// Golden seeds are always checked, so determinism is checked also when benchmark runs with other seeds.
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <iterator>
+using namespace std::chrono;
+
+static const int TREE_AREA = 512;	// columns -TREE_AREA ... TREE_AREA - 1 along both axes
+
+struct TreeGolden
+{
+	int seed;
+	size_t trees;
+	uint64_t hash;
+};
+static const TreeGolden TREE_GOLDEN[] =
+{
+	{ 12345678, 17798, 0xa581eb9ddfa4a3feull },
+	{ 1, 17921, 0x2c1e65c022b42855ull },
+	{ 1337, 17733, 0x101bfcee2f30d405ull },
+};
+
+static bool RunTrees(int seed, std::vector<std::string>& records)
+{
+	const WorldGenerator world_generator(seed);
+	const int size = 2 * TREE_AREA;
+	std::vector<uint8_t> trees(size * size);
+	auto start = high_resolution_clock::now();
+	world_generator.ShouldPlaceTrees(-TREE_AREA, -TREE_AREA, size, size, trees.data());
+	// per chunk (CHUNK_SIZE_X * CHUNK_SIZE_Z columns), batched
+	const double ns = NsPerItem(high_resolution_clock::now() - start, trees.size() / (CHUNK_SIZE_X * CHUNK_SIZE_Z));
+
+	// FNV-1a of tree column coordinates, row by row
+	size_t tree_count = 0;
+	uint64_t hash = 0xcbf29ce484222325ull;
+	bool consistent = true;	// batched and single column agree, otherwise no golden value can match
+	for (int z = 0; z < size && consistent; ++z)
+		for (int x = 0; x < size && consistent; ++x)
+		{
+			if (!trees[x + z * size])
+				continue;
+			consistent = world_generator.ShouldPlaceTree(x - TREE_AREA, z - TREE_AREA);
+			++tree_count;
+			for (int coordinate : { x - TREE_AREA, z - TREE_AREA })
+				for (int byte = 0; byte < 4; ++byte)
+				{
+					hash ^= (uint32_t)coordinate >> (byte * 8) & 0xff;
+					hash *= 0x100000001b3ull;
+				}
+		}
+
+	const TreeGolden* golden = std::find_if(std::begin(TREE_GOLDEN), std::end(TREE_GOLDEN),
+		[seed](const TreeGolden& golden) { return golden.seed == seed; });
+	const bool has_golden = golden != std::end(TREE_GOLDEN);
+	const bool matches_golden = has_golden && consistent && golden->trees == tree_count && golden->hash == hash;
+
+	std::ostringstream hex;
+	hex << std::hex << hash;
+	JsonRecord record;
+	record.Add("seed", seed).Add("trees", tree_count).Add("hash", hex.str()).Add("ns_per_chunk", ns);
+	if (has_golden)
+		record.Add("golden", matches_golden ? "match" : "mismatch");
+	else
+		record.AddNull("golden");
+	records.push_back(record.Str());
+	return !has_golden || matches_golden;
+}
+
+bool RunTreeCheck(const std::vector<int>& seeds, std::vector<std::string>& records)
+{
+	bool match = true;
+	for (const TreeGolden& golden : TREE_GOLDEN)
+		match = RunTrees(golden.seed, records) && match;
+	for (int seed : seeds)
+		if (std::none_of(std::begin(TREE_GOLDEN), std::end(TREE_GOLDEN), [seed](const TreeGolden& golden) { return golden.seed == seed; }))
+			match = RunTrees(seed, records) && match;
+	return match;
+}
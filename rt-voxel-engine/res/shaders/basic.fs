@@ -1,11 +1,18 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 v_TexCoord;
+in vec2 v_TexCoord;	// in tiles, so texture repeats across merged quads
+flat in float v_Tile;
 in float v_Light;
 uniform sampler2D texture0;
 
+// 16x16 atlas, every 16px tile has 1px border (see TextureAtlas)
+const float TILE_SIZE = 1.0 / 16.0;
+const float TILE_BORDER = TILE_SIZE / 18.0;
+
 void main()
 {
-    FragColor = texture(texture0, v_TexCoord) * v_Light;
+    vec2 tile = vec2(mod(v_Tile, 16.0), floor(v_Tile / 16.0));
+    vec2 uv = vec2(tile.x * TILE_SIZE, 1.0 - (tile.y + 1.0) * TILE_SIZE) + TILE_BORDER + fract(v_TexCoord) * (TILE_SIZE - 2.0 * TILE_BORDER);
+    FragColor = texture(texture0, uv) * v_Light;
 } 
\ No newline at end of file
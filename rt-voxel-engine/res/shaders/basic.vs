@@ -1,17 +1,35 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 texCoord;
-layout (location = 2) in float light;
+layout (location = 0) in uint vertex;	// packed, see ChunkVertex.h
 
 out vec2 v_TexCoord;
+flat out float v_Tile;
 out float v_Light;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 mesh_position;
+
+// indexed by Face: front, back, left, right, top, bottom
+const float FACE_LIGHTING[6] = float[6](0.84, 0.76, 0.68, 0.92, 1.0, 0.60);	//temporary simple lighting
+// indexed by baked ambient occlusion of vertex, 0 is fully occluded corner
+const float AO_LIGHTING[4] = float[4](0.45, 0.65, 0.85, 1.0);
 
 void main()
 {
-    gl_Position =  projection * view * vec4(aPos.x, aPos.y, aPos.z, 1.0);
-    v_TexCoord = texCoord;
-    v_Light = light;
-}
\ No newline at end of file
+    vec3 pos = vec3(float(vertex & 0x1fu), float((vertex >> 5) & 0x1ffu), float((vertex >> 14) & 0x1fu));
+    uint face = (vertex >> 19) & 0x7u;
+
+    // texture coordinates in tiles, aligned to block grid so texture repeats across merged quads
+    vec2 tex_coord;
+    if (face == 0u)      tex_coord = vec2(pos.x, pos.y);
+    else if (face == 1u) tex_coord = vec2(-pos.x, pos.y);
+    else if (face == 2u) tex_coord = vec2(pos.z, pos.y);
+    else if (face == 3u) tex_coord = vec2(-pos.z, pos.y);
+    else if (face == 4u) tex_coord = vec2(pos.x, -pos.z);
+    else                 tex_coord = vec2(pos.x, pos.z);
+
+    gl_Position =  projection * view * vec4(pos + mesh_position, 1.0);
+    v_TexCoord = tex_coord;
+    v_Tile = float((vertex >> 22) & 0xffu);
+    v_Light = FACE_LIGHTING[face] * AO_LIGHTING[(vertex >> 30) & 0x3u];
+}
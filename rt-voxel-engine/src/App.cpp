@@ -36,6 +36,7 @@ void App::Init(Window* window)
 	renderer_.Init(window_->GetWidth(), window_->GetHeigth());
 	renderer_.SetCamera(&camera_);
 
+	chunk_manager_.SetBakedWorld(BAKED_WORLD);
 	chunk_manager_.GenerateChunks();
 }
 
@@ -51,6 +52,8 @@ void App::ProcessInput(double delta_time)
 	if (input.IsActionJustPressed(Action::WIRE_FRAME_MODE))
 		renderer_.ToggleWireframeMode();
 #endif
+	if (input.IsActionJustPressed(Action::TOGGLE_GREEDY_MESHING))
+		chunk_manager_.SetMeshingMode(chunk_manager_.GetMeshingMode() == MeshingMode::Greedy ? MeshingMode::Naive : MeshingMode::Greedy);
 
 	player_.HandleInput(input, delta_time);
 
@@ -62,6 +65,7 @@ void App::Update(double delta_time)
 	player_.Update(delta_time);
 	if(DYNAMIC_WORLD)
 		chunk_manager_.UpdateCenter(player_.GetPosition());
+	chunk_manager_.UpdateDirtyChunks();
 
 	camera_.UpdateViewMatrix();
 	if (window_->SizeChanged() == true && window_->NotMinimized())
@@ -11,5 +11,51 @@
 										// Currently this feature is very WIP and may cause crashes
 										// Works acceptable with RENDER_DISTANCE up to ~20; safe value: 10
 
+#define BAKED_WORLD "baked-world"		// Directory with chunks pre-generated by ChunkBaker (baker/), they are loaded instead of generated
+										// Regions missing there are generated as usual, "" = always generate
+
+#define PALETTE_BLOCK_STORAGE true		// Palette compressed chunk blocks instead of flat BlockId array
+										// Set to false to compare memory and meshing time printed by ChunkManager::GenerateChunks
+										// or see "storage" check of headless benchmark, it compares both on the same area
+
+#define MESHING_ARENA true				// Reuse per thread meshing memory (MeshingArena) instead of allocating it in every Chunk::BuildMesh
+										// Set to false to compare "Building mesh time" printed by ChunkManager::GenerateChunks
+										// Default of ChunkManager::SetMeshingArena, "arena" check of headless benchmark compares both
+
+#define GREEDY_MESHING true				// Merge faces of same block into bigger quads, can be toggled at runtime (TOGGLE_GREEDY_MESHING action)
+
+#define BAKED_AO true					// Ambient occlusion per quad corner computed by mesher (2 bits in vertex), used by both renderers
+										// Costs 2 - 8% meshing time and 1.5 - 2x quads (splits greedy merges),
+										// default of ChunkManager::SetBakedAo, "ao" check of headless benchmark compares both
+
+#define SIMD_NOISE true					// Column heights of chunk are computed by batched noise (AVX2 / SSE4.1 lanes picked at runtime), same result
+										// as column by column when COARSE_NOISE_STEP is 1
+										// Set to false to compare "Generation time" printed by ChunkManager::GenerateChunks
+
+#define COARSE_NOISE_STEP 4				// Continentalness and erosion are sampled every 4th column and bilinearly interpolated (only with SIMD_NOISE)
+										// 1 = exact, height error against exact is checked by benchmark (COARSE_NOISE_MAX_HEIGHT_ERROR)
+
+#define SPLINE_LUT true					// Terrain splines are read from precomputed tables (SplineTable) instead of cosine interpolation per column
+										// Error below 0.01 block, checked by benchmark, set to false to compare "Generation time"
+
+#define CLIMATE_CACHE false				// Continentalness and erosion lattice (COARSE_NOISE_STEP > 1) is evaluated once per 512x512 region and kept
+										// in LRU cache shared by generating threads (ClimateCache), same heights as lattice per chunk,
+										// column by column GenerateHeight (SIMD_NOISE false) reads it too
+										// Off by default, "climate" check of headless benchmark shows no consistent win over lattice per chunk
+										// and every lookup takes cache mutex
+
+#define DENSITY_TERRAIN false			// Caves carved from stone and overhangs added above surface by 3D noise on 4x8x4 lattice, trilinearly interpolated
+										// Off by default, it changes world of every seed (baked regions of other setting are regenerated),
+										// benchmark reports cost of both ("density")
+
+#define LOD_MESHING true				// Mesh far chunks from 2x / 4x / 8x downsampled blocks (always greedy), skirts on borders towards other LOD hide seams
+#define LOD_RING_2X 32					// Distance in chunks from player chunk (chebyshev) from which each LOD level is used
+#define LOD_RING_4X 64
+#define LOD_RING_8X 128
+
+#define EDIT_CACHE_DISTANCE 2			// Chunks up to this distance (chebyshev) from player chunk keep CPU copy of their mesh per section,
+										// so block edit (also on chunk border, in neighbour) remeshes only sections it changed
+										// Farther chunks build it on their first edit, "edits" check of headless benchmark measures both
+
 // Player settings
 #define PLAYER_START_POS glm::vec3(8.0f, 140.0f, 8.0f)
@@ -1,8 +1,7 @@
 #pragma once
 
 #include "BlockId.h"
-#include "math/TextureAtlas.h"
-#include <array>
+#include "game/chunks/MeshLayer.h"
 
 class Block
 {
@@ -11,23 +10,24 @@ private:
 
 	bool transparent_;
 	bool collidable_;
+	MeshLayer mesh_layer_;
 
-	std::array<glm::vec2, 4> texture_uv_top_;
-	std::array<glm::vec2, 4> texture_uv_sides_;
-	std::array<glm::vec2, 4> texture_uv_bottom_;
+	// atlas tile indices, atlas uv's are computed in shaders so merged (greedy) quads can repeat the tile
+	int texture_top_;
+	int texture_sides_;
+	int texture_bottom_;
 public:
 	Block() {}
-	Block(BlockId id, bool transparent, bool collidable, TextureAtlas& atlas, int tex_top_index, int tex_sides_index, int tex_bottom_index)
-		: id_(id), transparent_(transparent), collidable_(collidable)
+	Block(BlockId id, bool transparent, bool collidable, int tex_top_index, int tex_sides_index, int tex_bottom_index, MeshLayer mesh_layer = MeshLayer::Opaque)
+		: id_(id), transparent_(transparent), collidable_(collidable), mesh_layer_(mesh_layer),
+		texture_top_(tex_top_index), texture_sides_(tex_sides_index), texture_bottom_(tex_bottom_index)
 	{
-		texture_uv_top_ = atlas.getUVs(tex_top_index);
-		texture_uv_sides_ = atlas.getUVs(tex_sides_index);
-		texture_uv_bottom_ = atlas.getUVs(tex_bottom_index);
 	};
 	inline BlockId getId() const { return id_; }
 	inline bool isTransparent() const { return transparent_; }
 	inline bool isCollidable() const { return collidable_; }
-	inline const std::array<glm::vec2, 4>& getUVTop() const { return texture_uv_top_; }
-	inline const std::array<glm::vec2, 4>& getUVSides() const { return texture_uv_sides_; }
-	inline const std::array<glm::vec2, 4>& getUVBottom() const { return texture_uv_bottom_; }
+	inline MeshLayer getMeshLayer() const { return mesh_layer_; }
+	inline int getTextureTop() const { return texture_top_; }
+	inline int getTextureSides() const { return texture_sides_; }
+	inline int getTextureBottom() const { return texture_bottom_; }
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Block.h"
-#include "math/TextureAtlas.h"
+#include <glm/glm.hpp>
 #include <array>
 
 enum class Face : unsigned char
@@ -21,7 +21,6 @@ class BlockDatabase
 private:
 	std::array<Block, static_cast<int>(BlockId::NUM_TYPES)> blocks_;
 	std::array<std::array<glm::vec3, 4>, static_cast<int>(Face::NUM_FACES)> faces_;
-	std::array<float, static_cast<int>(Face::NUM_FACES)> faces_lighting_;
 
 	const std::array<glm::vec3, 4> FRONT_FACE
 	{
@@ -38,18 +37,16 @@ private:
 public:
 	BlockDatabase()
 	{
-		TextureAtlas atlas(16.0, 16, 16);
-		blocks_[static_cast<int>(BlockId::Air)] = Block(BlockId::Air, true, false, atlas, -1, -1, -1);
-		blocks_[static_cast<int>(BlockId::Grass)] = Block(BlockId::Grass, false, true, atlas, 0, 1, 2);
-		blocks_[static_cast<int>(BlockId::Dirt)] = Block(BlockId::Dirt, false, true, atlas, 2, 2, 2);
-		blocks_[static_cast<int>(BlockId::Stone)] = Block(BlockId::Stone, false, true, atlas, 3, 3, 3);
-		blocks_[static_cast<int>(BlockId::Sand)] = Block(BlockId::Sand, false, true, atlas, 16, 16, 16);
-		blocks_[static_cast<int>(BlockId::Water)] = Block(BlockId::Water, true, false, atlas, 32, 32, 32);
-		blocks_[static_cast<int>(BlockId::Wood)] = Block(BlockId::Wood, false, true, atlas, 19, 18, 19);
-		blocks_[static_cast<int>(BlockId::Leaves)] = Block(BlockId::Leaves, true, true, atlas, 20, 20, 20);
+		blocks_[static_cast<int>(BlockId::Air)] = Block(BlockId::Air, true, false, -1, -1, -1);
+		blocks_[static_cast<int>(BlockId::Grass)] = Block(BlockId::Grass, false, true, 0, 1, 2);
+		blocks_[static_cast<int>(BlockId::Dirt)] = Block(BlockId::Dirt, false, true, 2, 2, 2);
+		blocks_[static_cast<int>(BlockId::Stone)] = Block(BlockId::Stone, false, true, 3, 3, 3);
+		blocks_[static_cast<int>(BlockId::Sand)] = Block(BlockId::Sand, false, true, 16, 16, 16);
+		blocks_[static_cast<int>(BlockId::Water)] = Block(BlockId::Water, true, false, 32, 32, 32, MeshLayer::Refractive);
+		blocks_[static_cast<int>(BlockId::Wood)] = Block(BlockId::Wood, false, true, 19, 18, 19);
+		blocks_[static_cast<int>(BlockId::Leaves)] = Block(BlockId::Leaves, true, true, 20, 20, 20, MeshLayer::AlphaTested);
 
 		faces_ = { FRONT_FACE, BACK_FACE, LEFT_FACE, RIGHT_FACE, TOP_FACE, BOTTOM_FACE };
-		faces_lighting_ = { 0.84f, 0.76f, 0.68f, 0.92f, 1.0f, 0.60f };	//temporary simple lighting
 	}
 
 	inline const Block& GetBlockData(BlockId block_id) const
@@ -61,9 +58,4 @@ public:
 	{
 		return faces_[static_cast<int>(face)];
 	}
-	//temporary simple lighting
-	inline const float GetFaceLighting(Face face) const
-	{
-		return faces_lighting_[static_cast<int>(face)];
-	}
 };
\ No newline at end of file
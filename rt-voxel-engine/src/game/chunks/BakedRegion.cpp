@@ -0,0 +1,74 @@
+#include "BakedRegion.h"
+#include <fstream>
+
+BakedRegion::BakedRegion(int seed, uint32_t settings, int region_x, int region_z)
+	: seed_(seed), settings_(settings), region_x_(region_x), region_z_(region_z)
+{
+	table_.fill({ 0, 0 });
+}
+
+std::string BakedRegion::GetPath(const std::string& directory, int region_x, int region_z)
+{
+	return directory + "/r." + std::to_string(region_x) + "." + std::to_string(region_z) + ".region";
+}
+
+bool BakedRegion::Read(const std::string& path)
+{
+	table_.fill({ 0, 0 });
+	records_.clear();
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	const size_t file_size = (size_t)file.tellg();
+	const size_t records_begin = HEADER_SIZE + sizeof(table_);
+	if (file_size < records_begin)
+		return false;
+
+	int32_t header[6];
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(header), HEADER_SIZE);
+	if (!file || header[0] != MAGIC || header[1] != VERSION || header[2] != seed_ || (uint32_t)header[3] != settings_ ||
+		header[4] != region_x_ || header[5] != region_z_)
+		return false;
+	decltype(table_) table;
+	file.read(reinterpret_cast<char*>(table.data()), sizeof(table));
+	records_.resize(file_size - records_begin);
+	file.read(reinterpret_cast<char*>(records_.data()), records_.size());
+	if (!file)
+	{
+		records_.clear();
+		return false;
+	}
+	for (const std::pair<uint32_t, uint32_t>& entry : table)
+		if ((size_t)entry.first + entry.second > records_.size())
+		{
+			records_.clear();
+			return false;
+		}
+	table_ = table;
+	return true;
+}
+
+bool BakedRegion::Write(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const int32_t header[6] = { MAGIC, VERSION, seed_, (int32_t)settings_, region_x_, region_z_ };
+	file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+	file.write(reinterpret_cast<const char*>(table_.data()), sizeof(table_));
+	file.write(reinterpret_cast<const char*>(records_.data()), records_.size());
+	return (bool)file;
+}
+
+// records are only appended, chunk baked twice keeps its first record unreachable
+void BakedRegion::SetChunk(int local_x, int local_z, const std::vector<uint8_t>& record)
+{
+	table_[local_x + local_z * REGION_CHUNKS] = { (uint32_t)records_.size(), (uint32_t)record.size() };
+	records_.insert(records_.end(), record.begin(), record.end());
+}
+
+const uint8_t* BakedRegion::GetChunk(int local_x, int local_z, size_t& size) const
+{
+	const std::pair<uint32_t, uint32_t>& entry = table_[local_x + local_z * REGION_CHUNKS];
+	size = entry.second;
+	return size == 0 ? nullptr : records_.data() + entry.first;
+}
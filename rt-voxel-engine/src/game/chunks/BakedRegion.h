@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Chunks pre-generated offline (baker/ChunkBaker), REGION_CHUNKS x REGION_CHUNKS chunks per file, ChunkManager loads them instead
+// of generating (BAKED_WORLD in config.h). File "r.<region_x>.<region_z>.region" in world directory, little endian (x86 / x64):
+//   header   "RVXR", VERSION, seed, settings, region_x, region_z (int32)
+//   table    (offset, size) uint32 pair per chunk (local_x + local_z * REGION_CHUNKS), offset from first record, size 0 = not baked
+//   records  Chunk::WriteBaked, one after another
+// Settings are WorldGenerator::GetSettingsFingerprint, region baked with other settings or seed is not loaded (chunks are generated).
+// Whole file is read at once, records are then decoded by generating threads straight from memory.
+class BakedRegion
+{
+public:
+	static const int REGION_CHUNKS = 32;	// 512 blocks, same area as ClimateCache region
+	static const int32_t VERSION = 2;
+
+	BakedRegion(int seed, uint32_t settings, int region_x, int region_z);
+	static std::string GetPath(const std::string& directory, int region_x, int region_z);
+	bool Read(const std::string& path);		// false (and no chunks) when file is missing, broken, of other version, seed or settings
+	bool Write(const std::string& path) const;
+
+	void SetChunk(int local_x, int local_z, const std::vector<uint8_t>& record);
+	const uint8_t* GetChunk(int local_x, int local_z, size_t& size) const;	// record, nullptr when chunk is not baked
+	inline int GetRegionX() const { return region_x_; };
+	inline int GetRegionZ() const { return region_z_; };
+	inline size_t GetSize() const { return records_.size(); };	// of all records
+private:
+	static const int32_t MAGIC = 0x52585652;	// "RVXR"
+	static const int HEADER_SIZE = 6 * sizeof(int32_t);
+	static const int CHUNKS = REGION_CHUNKS * REGION_CHUNKS;
+
+	int seed_;
+	uint32_t settings_;
+	int region_x_;
+	int region_z_;
+	std::array<std::pair<uint32_t, uint32_t>, CHUNKS> table_;	// offset into records_, size
+	std::vector<uint8_t> records_;
+};
@@ -0,0 +1,169 @@
+#include "BlockStorage.h"
+#include <algorithm>
+#include <array>
+
+FlatBlockStorage::FlatBlockStorage(int volume)
+	: blocks_(volume, BlockId::Air)
+{
+}
+
+void FlatBlockStorage::Fill(BlockId block)
+{
+	std::fill(blocks_.begin(), blocks_.end(), block);
+}
+
+void FlatBlockStorage::Assign(const BlockId* blocks)
+{
+	std::copy(blocks, blocks + blocks_.size(), blocks_.begin());
+}
+
+void FlatBlockStorage::AssignRuns(const BlockRun* runs, int count)
+{
+	auto cell = blocks_.begin();
+	for (int run = 0; run < count; ++run)
+		cell = std::fill_n(cell, runs[run].length, runs[run].block);
+}
+
+size_t FlatBlockStorage::MemoryUsage() const
+{
+	return sizeof(*this) + blocks_.capacity() * sizeof(BlockId);
+}
+
+PaletteBlockStorage::PaletteBlockStorage(int volume)
+	: volume_(volume), bits_per_block_(0), index_mask_(0), palette_(1, BlockId::Air)
+{
+}
+
+void PaletteBlockStorage::Set(int index, BlockId block)
+{
+	int palette_index = GetPaletteIndex(block);
+	if (palette_index < 0)
+	{
+		palette_index = static_cast<int>(palette_.size());
+		palette_.push_back(block);
+		if (palette_.size() > (size_t(1) << bits_per_block_))
+			Widen(bits_per_block_ == 0 ? 1 : bits_per_block_ * 2);
+	}
+	if (bits_per_block_ == 0)
+		return;
+
+	const unsigned int bit = index * bits_per_block_;
+	uint64_t& word = data_[bit >> 6];
+	word = (word & ~(index_mask_ << (bit & 63))) | (uint64_t(palette_index) << (bit & 63));
+}
+
+void PaletteBlockStorage::Fill(BlockId block)
+{
+	palette_.assign(1, block);
+	bits_per_block_ = 0;
+	index_mask_ = 0;
+	data_.clear();
+	data_.shrink_to_fit();
+}
+
+void PaletteBlockStorage::Assign(const BlockId* blocks)
+{
+	std::array<uint8_t, static_cast<size_t>(BlockId::NUM_TYPES)> palette_index;
+	palette_index.fill(0xff);
+	palette_.clear();
+	for (int i = 0; i < volume_; ++i)
+		if (palette_index[static_cast<size_t>(blocks[i])] == 0xff)
+		{
+			palette_index[static_cast<size_t>(blocks[i])] = static_cast<uint8_t>(palette_.size());
+			palette_.push_back(blocks[i]);
+		}
+
+	bits_per_block_ = 0;
+	while (palette_.size() > (size_t(1) << bits_per_block_))
+		bits_per_block_ = bits_per_block_ == 0 ? 1 : bits_per_block_ * 2;
+	index_mask_ = (uint64_t(1) << bits_per_block_) - 1;
+	if (bits_per_block_ == 0)
+	{
+		data_.clear();
+		data_.shrink_to_fit();
+		return;
+	}
+
+	data_.assign(((size_t)volume_ * bits_per_block_ + 63) / 64, 0);
+	for (int i = 0; i < volume_; ++i)
+	{
+		const unsigned int bit = i * bits_per_block_;
+		data_[bit >> 6] |= uint64_t(palette_index[static_cast<size_t>(blocks[i])]) << (bit & 63);
+	}
+}
+
+void PaletteBlockStorage::AssignRuns(const BlockRun* runs, int count)
+{
+	std::array<uint8_t, static_cast<size_t>(BlockId::NUM_TYPES)> palette_index;
+	palette_index.fill(0xff);
+	palette_.clear();
+	for (int run = 0; run < count; ++run)
+		if (palette_index[static_cast<size_t>(runs[run].block)] == 0xff)
+		{
+			palette_index[static_cast<size_t>(runs[run].block)] = static_cast<uint8_t>(palette_.size());
+			palette_.push_back(runs[run].block);
+		}
+
+	bits_per_block_ = 0;
+	while (palette_.size() > (size_t(1) << bits_per_block_))
+		bits_per_block_ = bits_per_block_ == 0 ? 1 : bits_per_block_ * 2;
+	index_mask_ = (uint64_t(1) << bits_per_block_) - 1;
+	if (bits_per_block_ == 0)
+	{
+		data_.clear();
+		data_.shrink_to_fit();
+		return;
+	}
+
+	data_.assign(((size_t)volume_ * bits_per_block_ + 63) / 64, 0);
+	const int cells_per_word = 64 / bits_per_block_;
+	int cell = 0;
+	for (int run = 0; run < count; ++run)
+	{
+		const uint64_t index = palette_index[static_cast<size_t>(runs[run].block)];
+		const int end = cell + runs[run].length;
+		for (; cell < end && cell % cells_per_word != 0; ++cell)
+			data_[cell / cells_per_word] |= index << (cell % cells_per_word * bits_per_block_);
+		uint64_t word = 0;
+		for (int i = 0; i < cells_per_word; ++i)
+			word |= index << (i * bits_per_block_);
+		for (; cell + cells_per_word <= end; cell += cells_per_word)
+			data_[cell / cells_per_word] = word;
+		for (; cell < end; ++cell)
+			data_[cell / cells_per_word] |= index << (cell % cells_per_word * bits_per_block_);
+	}
+}
+
+size_t PaletteBlockStorage::MemoryUsage() const
+{
+	return sizeof(*this) + palette_.capacity() * sizeof(BlockId) + data_.capacity() * sizeof(uint64_t);
+}
+
+int PaletteBlockStorage::GetPaletteIndex(BlockId block) const
+{
+	// palette is tiny (at most BlockId::NUM_TYPES entries) so linear scan is fine
+	for (size_t i = 0; i < palette_.size(); ++i)
+		if (palette_[i] == block)
+			return static_cast<int>(i);
+	return -1;
+}
+
+void PaletteBlockStorage::Widen(int bits_per_block)
+{
+	std::vector<uint64_t> data(((size_t)volume_ * bits_per_block + 63) / 64, 0);
+	const uint64_t index_mask = (uint64_t(1) << bits_per_block) - 1;
+
+	// going from 0 bits all indices are 0 anyway, so there is nothing to repack
+	if (bits_per_block_ != 0)
+		for (int i = 0; i < volume_; ++i)
+		{
+			const unsigned int old_bit = i * bits_per_block_;
+			const uint64_t palette_index = (data_[old_bit >> 6] >> (old_bit & 63)) & index_mask_;
+			const unsigned int new_bit = i * bits_per_block;
+			data[new_bit >> 6] |= palette_index << (new_bit & 63);
+		}
+
+	data_ = std::move(data);
+	bits_per_block_ = bits_per_block;
+	index_mask_ = index_mask;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "config.h"
+#include "game/blocks/BlockId.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// cells index ... index + length - 1 hold block, runs go one after another from cell 0
+struct BlockRun
+{
+	BlockId block;
+	int length;
+};
+
+// Plain array backend, one BlockId per cell. Kept mostly for comparison with PaletteBlockStorage (see PALETTE_BLOCK_STORAGE in config.h)
+class FlatBlockStorage
+{
+public:
+	FlatBlockStorage(int volume);
+
+	inline BlockId Get(int index) const { return blocks_[index]; }
+	inline void Set(int index, BlockId block) { blocks_[index] = block; }
+	void Fill(BlockId block);
+	void Assign(const BlockId* blocks);	// whole volume at once
+	void AssignRuns(const BlockRun* runs, int count);	// whole volume at once, lengths add up to volume
+	inline bool IsUniform() const { return false; }
+	size_t MemoryUsage() const;
+private:
+	std::vector<BlockId> blocks_;
+};
+
+// Palette + packed bit index backend. Every cell keeps only index into small palette of blocks used in the storage,
+// indices are packed into 64 bit words. Bit width grows on demand (0, 1, 2, 4, 8) so entry never straddle two words,
+// bit width 0 means whole storage is filled with palette_[0] and no words are allocated at all.
+class PaletteBlockStorage
+{
+public:
+	PaletteBlockStorage(int volume);
+
+	inline BlockId Get(int index) const
+	{
+		if (bits_per_block_ == 0)
+			return palette_[0];
+		const unsigned int bit = index * bits_per_block_;
+		return palette_[(data_[bit >> 6] >> (bit & 63)) & index_mask_];
+	}
+	void Set(int index, BlockId block);
+	void Fill(BlockId block);
+	void Assign(const BlockId* blocks);	// whole volume at once, palette and bit width are chosen before packing, so nothing is repacked
+	void AssignRuns(const BlockRun* runs, int count);	// as Assign, words inside of run are written whole
+	inline bool IsUniform() const { return bits_per_block_ == 0; }
+	size_t MemoryUsage() const;
+private:
+	int GetPaletteIndex(BlockId block) const;
+	void Widen(int bits_per_block);
+
+	int volume_;
+	int bits_per_block_;
+	uint64_t index_mask_;
+	std::vector<BlockId> palette_;
+	std::vector<uint64_t> data_;
+};
+
+#if PALETTE_BLOCK_STORAGE
+using BlockStorage = PaletteBlockStorage;
+#else
+using BlockStorage = FlatBlockStorage;
+#endif
@@ -1,23 +1,35 @@
 #include "Chunk.h"
+#include "ChunkVertex.h"
+#include "GenerationContext.h"
+#include "MeshingArena.h"
+#include "config.h"
 #include <FastNoiseLite/FastNoiseLite.h>
-#include <chrono>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
-using namespace std::chrono;
+#include <memory>
 
 Chunk::Chunk(glm::i64vec3 global_position, ChunkManager& chunk_manager)
-	:global_position_(global_position), chunk_manager_(chunk_manager), generated_(false), meshed_(false)
+	:global_position_(global_position), chunk_manager_(chunk_manager), stage_(GenerationStage::Empty), meshed_(false), dirty_sections_(0), lod_(1)
 #ifdef VULKAN
 	, blased_(false)
 #endif
+#ifdef HEADLESS
+	, vertex_count_(0)
+#endif
 {
-
+	height_summary_.Reset();
 }
 
 void Chunk::ReuseChunk(glm::i64vec3 global_position)
 {
 	global_position_ = global_position;
-	generated_ = false;
+	stage_ = GenerationStage::Empty;
 	meshed_ = false;
+	dirty_sections_ = 0;
+	section_vertices_.reset();
+	height_summary_.Reset();
 	#ifdef VULKAN
 	blased_ = false;
 	#endif
@@ -32,29 +44,389 @@ const bool Chunk::Blased()
 }
 #endif
 
-void Chunk::Generate() 
+void Chunk::GenerateStage(GenerationStage stage)
 {
-	WorldGenerator world_generator = chunk_manager_.GetWorldGenerator();
+	assert(static_cast<int>(stage) == static_cast<int>(stage_) + 1);
+	switch (stage)
+	{
+	case GenerationStage::Terrain:
+		GenerateTerrain();
+		break;
+	case GenerationStage::Surface:
+		GenerateSurface();
+		break;
+	case GenerationStage::Decoration:
+		GenerateDecoration();
+		break;
+	case GenerationStage::Lit:
+		// nothing to bake, renderer traces light, but from now neighbours blocks are final and nobody needs column heights
+		column_heights_.reset();
+		break;
+	default:
+		break;
+	}
+	stage_ = stage;
+}
 
-	for (int z = 0; z < CHUNK_SIZE_Z; ++z) 
+// fills part of column run [y_begin, y_end) inside of section starting at section_begin, blocks are in section layout (see GetIndex)
+static void FillColumnRun(BlockId* blocks, int column, int section_begin, int y_begin, int y_end, BlockId block)
+{
+	y_begin = std::max(y_begin, section_begin) - section_begin;
+	y_end = std::min(y_end, section_begin + SECTION_SIZE) - section_begin;
+	for (int y = y_begin; y < y_end; ++y)
+		blocks[column + y * CHUNK_SIZE_X * CHUNK_SIZE_Z] = block;
+}
+
+const int DENSITY_LATTICE_X = CHUNK_SIZE_X / DENSITY_STEP_XZ + 1;
+const int DENSITY_LATTICE_Z = CHUNK_SIZE_Z / DENSITY_STEP_XZ + 1;
+const int DENSITY_LATTICE_COLUMNS = DENSITY_LATTICE_X * DENSITY_LATTICE_Z;
+
+// bounds of lattice values of cells covering layers y_begin ... y_end - 1, trilinear interpolation never leaves them
+static void DensityBounds(const float* lattice, int lattice_size_y, int y_begin, int y_end, float& min, float& max)
+{
+	const int row_begin = y_begin / DENSITY_STEP_Y;
+	const int row_end = (y_end - 1) / DENSITY_STEP_Y + 1;
+	min = lattice[row_begin];
+	max = lattice[row_begin];
+	for (int column = 0; column < DENSITY_LATTICE_COLUMNS; ++column)
+		for (int row = row_begin; row <= row_end; ++row)
+		{
+			min = std::min(min, lattice[row + column * lattice_size_y]);
+			max = std::max(max, lattice[row + column * lattice_size_y]);
+		}
+}
+
+// carves stone of layers y_begin ... y_end - 1 (blocks in section layout starting at section_begin) where density interpolated
+// from lattice is negative and adds stone above column top where it is above overhang threshold (added blocks go into summary),
+// returns lowest carved y (CHUNK_SIZE_Y if none), loops over x are plain arrays, so compiler vectorizes them
+static int ShapeLayers(const WorldGenerator& world_generator, const ColumnHeights& heights, const float* overhang, const float* cave,
+	int lattice_size_y, int section_begin, int y_begin, int y_end, BlockId* blocks, HeightSummary& summary)
+{
+	int lowest_carved = CHUNK_SIZE_Y;
+	std::array<float, DENSITY_LATTICE_COLUMNS> overhang_y, cave_y;
+	for (int y = y_begin; y < y_end; ++y)
 	{
-		for (int x = 0; x < CHUNK_SIZE_X; ++x) 
+		const int row = y / DENSITY_STEP_Y;
+		const float ty = (float)(y % DENSITY_STEP_Y) / DENSITY_STEP_Y;
+		for (int column = 0; column < DENSITY_LATTICE_COLUMNS; ++column)
+		{
+			const int i = row + column * lattice_size_y;
+			overhang_y[column] = overhang[i] + ty * (overhang[i + 1] - overhang[i]);
+			cave_y[column] = cave[i] + ty * (cave[i + 1] - cave[i]);
+		}
+
+		BlockId* layer = blocks + (y - section_begin) * CHUNK_SIZE_X * CHUNK_SIZE_Z;
+		for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+		{
+			const int cell_z = z / DENSITY_STEP_XZ;
+			const float tz = (float)(z % DENSITY_STEP_XZ) / DENSITY_STEP_XZ;
+			std::array<float, DENSITY_LATTICE_X> overhang_z, cave_z;
+			for (int i = 0; i < DENSITY_LATTICE_X; ++i)
+			{
+				const int near = i + cell_z * DENSITY_LATTICE_X;
+				const int far = near + DENSITY_LATTICE_X;
+				overhang_z[i] = overhang_y[near] + tz * (overhang_y[far] - overhang_y[near]);
+				cave_z[i] = cave_y[near] + tz * (cave_y[far] - cave_y[near]);
+			}
+
+			std::array<float, CHUNK_SIZE_X> density;
+			for (int x = 0; x < CHUNK_SIZE_X; ++x)
+			{
+				const int cell_x = x / DENSITY_STEP_XZ;
+				const float tx = (float)(x % DENSITY_STEP_XZ) / DENSITY_STEP_XZ;
+				density[x] = world_generator.CombineDensity(overhang_z[cell_x] + tx * (overhang_z[cell_x + 1] - overhang_z[cell_x]),
+					cave_z[cell_x] + tx * (cave_z[cell_x + 1] - cave_z[cell_x]), y, heights[x + z * CHUNK_SIZE_X]);
+			}
+			for (int x = 0; x < CHUNK_SIZE_X; ++x)
+			{
+				const HeightPayload& height = heights[x + z * CHUNK_SIZE_X];
+				if (density[x] < 0.0f && world_generator.IsCarvable(y, height))
+				{
+					layer[x + z * CHUNK_SIZE_X] = BlockId::Air;
+					lowest_carved = std::min(lowest_carved, y);
+				}
+				else if (density[x] > world_generator.GetOverhangThreshold() && world_generator.IsRaisable(y, height))
+				{
+					layer[x + z * CHUNK_SIZE_X] = BlockId::Stone;
+					summary.max_y = std::max(summary.max_y, y);
+					summary.heightmap[x + z * CHUNK_SIZE_X] = std::max<int16_t>(summary.heightmap[x + z * CHUNK_SIZE_X], y);
+				}
+			}
+		}
+	}
+	return lowest_carved;
+}
+
+void Chunk::GenerateTerrain()
+{
+	const WorldGenerator& world_generator = chunk_manager_.GetWorldGenerator();
+	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
+	GenerationContext& context = GenerationContext::ForCurrentThread();
+
+	// heights first, so we know which sections are for sure only stone or only air
+	if (!column_heights_)
+		column_heights_ = std::make_unique<ColumnHeights>();
+	ColumnHeights& heights = *column_heights_;
+	const int chunk_world_x = global_position_.x * CHUNK_SIZE_X;
+	const int chunk_world_z = global_position_.z * CHUNK_SIZE_Z;
+	if (SIMD_NOISE)
+		world_generator.GenerateHeights(chunk_world_x, chunk_world_z, CHUNK_SIZE_X, CHUNK_SIZE_Z, heights.data(), context);
+	else
+		for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+			for (int x = 0; x < CHUNK_SIZE_X; ++x)
+				heights[x + z * CHUNK_SIZE_X] = world_generator.GenerateHeight(x + chunk_world_x, z + chunk_world_z);
+
+	// spans of every column clipped to chunk, summary is collected from them, surface band (above stone top up to height)
+	// is left to surface stage, it places only non transparent blocks there, so summary counts with it as if it was already placed
+	std::vector<BlockSpan>& spans = context.spans;
+	spans.resize(CHUNK_SIZE_X * CHUNK_SIZE_Z * MAX_COLUMN_SPANS);
+	std::array<uint8_t, CHUNK_SIZE_X * CHUNK_SIZE_Z> span_count;
+
+	HeightSummary& summary = height_summary_;
+	summary.Reset();
+	int stone_top = CHUNK_SIZE_Y - 1;
+	int column_top = 0;
+	int solid_end = CHUNK_SIZE_Y;
+	int carve_top = 0;	// highest block density terrain can carve, lowest and highest column for its bounds
+	int raise_bottom = CHUNK_SIZE_Y, raise_top = 0;	// lowest and highest block density terrain can add
+	HeightPayload lowest_column = heights[0], highest_column = heights[0];
+	for (int column = 0; column < CHUNK_SIZE_X * CHUNK_SIZE_Z; ++column)
+	{
+		const HeightPayload& height = heights[column];
+		stone_top = std::min(stone_top, world_generator.GetColumnStoneTop(height));
+		column_top = std::max(column_top, world_generator.GetColumnTop(height));
+		carve_top = std::max(carve_top, std::min(world_generator.GetColumnStoneTop(height), CHUNK_SIZE_Y - 1));
+		raise_bottom = std::min(raise_bottom, world_generator.GetColumnTop(height) + 1);
+		raise_top = std::max(raise_top, std::min(world_generator.GetColumnTop(height) + OVERHANG_HEIGHT, CHUNK_SIZE_Y - 1));
+		if (height.height < lowest_column.height)
+			lowest_column = height;
+		if (height.height > highest_column.height)
+			highest_column = height;
+
+		BlockSpan* column_spans = &spans[column * MAX_COLUMN_SPANS];
+		const int count = world_generator.GetColumnSpans(height, column_spans);
+		int clipped = 0;
+		for (int i = 0; i < count; ++i)
+			if (column_spans[i].y_begin < CHUNK_SIZE_Y)
+			{
+				column_spans[clipped] = column_spans[i];
+				column_spans[clipped++].y_end = std::min(column_spans[i].y_end, CHUNK_SIZE_Y);
+			}
+		span_count[column] = clipped;
+
+		// solid layers end at first transparent block from the bottom, air above spans included
+		int column_solid_end = 0;
+		for (int i = 0; i < clipped && column_spans[i].y_begin == column_solid_end; ++i)
 		{
-			int worldX = x + global_position_.x * CHUNK_SIZE_X;
-			int worldZ = z + global_position_.z * CHUNK_SIZE_Z;
+			if (db.GetBlockData(column_spans[i].block).isTransparent())
+				break;
+			column_solid_end = column_spans[i].y_end;
+		}
+		solid_end = std::min(solid_end, column_solid_end);
+
+		if (clipped == 0)
+			continue;
+		summary.min_y = std::min(summary.min_y, column_spans[0].y_begin);
+		summary.max_y = std::max(summary.max_y, column_spans[clipped - 1].y_end - 1);
+		summary.heightmap[column] = column_spans[clipped - 1].y_end - 1;
+		for (int i = 0; i < clipped; ++i)
+			if (column_spans[i].block == BlockId::Water)
+			{
+				summary.water_min_y = std::min(summary.water_min_y, column_spans[i].y_begin);
+				summary.water_max_y = std::max(summary.water_max_y, column_spans[i].y_end - 1);
+			}
+	}
 
-			HeightPayload height = world_generator.GenerateHeight(worldX, worldZ);
+	// density terrain lattice covers all carvable and raisable layers, plus one row above them for interpolation
+	const bool density = world_generator.GetDensityTerrain() && (carve_top >= 1 || raise_bottom <= raise_top);
+	const int lattice_size_y = std::max(carve_top, raise_top) / DENSITY_STEP_Y + 2;
+	float* overhang = nullptr;
+	float* cave = nullptr;
+	if (density)
+	{
+		context.density.resize(DENSITY_LATTICE_COLUMNS * lattice_size_y * static_cast<int>(DensityNoise::COUNT));
+		overhang = context.density.data();
+		cave = overhang + DENSITY_LATTICE_COLUMNS * lattice_size_y;
+		world_generator.GenerateDensityLattice(chunk_world_x, chunk_world_z, DENSITY_LATTICE_X, lattice_size_y, DENSITY_LATTICE_Z, overhang, cave);
+	}
 
-			for (int y = 0; y < CHUNK_SIZE_Y; ++y)
+	// mixed sections are built in plain array and handed to section at once, so palette is packed only once
+	std::vector<BlockId>& section_blocks = context.section_blocks;
+	section_blocks.resize(SECTION_VOLUME);
+	for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+	{
+		ChunkSection& section = sections_[section_y];
+		const int y_begin = section_y * SECTION_SIZE;
+		const int y_end = y_begin + SECTION_SIZE;
+
+		// lattice bounds give bounds of density, with them section is either left as it is, shaped block by block,
+		// or (only stone which is all carved) it is empty
+		const int raise_begin = std::max(y_begin, raise_bottom);
+		const int raise_end = std::min(y_end, raise_top + 1);
+		bool raise = false;
+		if (density && raise_begin < raise_end)
+		{
+			float overhang_min, overhang_max, cave_min, cave_max;
+			DensityBounds(overhang, lattice_size_y, raise_begin, raise_end, overhang_min, overhang_max);
+			DensityBounds(cave, lattice_size_y, raise_begin, raise_end, cave_min, cave_max);
+			raise = world_generator.CombineDensity(overhang_max, cave_min, raise_begin, highest_column) > world_generator.GetOverhangThreshold();
+		}
+		if (y_begin > column_top && !raise)
+		{
+			section.Fill(BlockId::Air, db);
+			continue;
+		}
+		const int carve_begin = std::max(y_begin, 1);
+		const int carve_end = std::min(y_end, carve_top + 1);
+		bool carve = false;
+		if (density && carve_begin < carve_end)
+		{
+			float overhang_min, overhang_max, cave_min, cave_max;
+			DensityBounds(overhang, lattice_size_y, carve_begin, carve_end, overhang_min, overhang_max);
+			DensityBounds(cave, lattice_size_y, carve_begin, carve_end, cave_min, cave_max);
+			carve = world_generator.CombineDensity(overhang_min, cave_max, carve_end - 1, lowest_column) < 0.0f;
+			if (carve && y_begin >= 1 && y_end - 1 <= stone_top &&
+				world_generator.CombineDensity(overhang_max, cave_min, y_begin, highest_column) < 0.0f)
+			{
+				section.Fill(BlockId::Air, db);
+				solid_end = std::min(solid_end, y_begin);
+				continue;
+			}
+		}
+		if (y_end - 1 <= stone_top && !carve)
+		{
+			section.Fill(BlockId::Stone, db);
+			for (int y = y_begin; y < y_end; ++y)
+				if (y % 32 == 0)
+					for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+						for (int x = 0; x < CHUNK_SIZE_X; ++x)
+							section.SetBlock(GetIndex(x, y, z), BlockId::Wood, db);
+			continue;
+		}
+
+		std::fill(section_blocks.begin(), section_blocks.end(), BlockId::Air);
+		for (int column = 0; column < CHUNK_SIZE_X * CHUNK_SIZE_Z; ++column)
+		{
+			const HeightPayload& height = heights[column];
+			const int surface_begin = world_generator.GetColumnStoneTop(height) + 1;
+			const int surface_end = height.height + 1;
+			const BlockSpan* column_spans = &spans[column * MAX_COLUMN_SPANS];
+			for (int i = 0; i < span_count[column]; ++i)
 			{
-				BlockId block = world_generator.GetBlockType(x, y, z, height);
-				if (block == BlockId::Stone && y % 32 == 0)
-					block = BlockId::Wood;
-				blocks_[GetIndex(x, y, z)] = block;
+				const BlockSpan& span = column_spans[i];
+				FillColumnRun(section_blocks.data(), column, y_begin, span.y_begin, std::min(span.y_end, surface_begin), span.block);
+				FillColumnRun(section_blocks.data(), column, y_begin, std::max(span.y_begin, surface_end), span.y_end, span.block);
 			}
 		}
+		if (y_begin % 32 == 0)
+			std::replace(section_blocks.begin(), section_blocks.begin() + CHUNK_SIZE_X * CHUNK_SIZE_Z, BlockId::Stone, BlockId::Wood);
+		if (carve || raise)
+			solid_end = std::min(solid_end, ShapeLayers(world_generator, heights, overhang, cave, lattice_size_y, y_begin,
+				carve ? carve_begin : raise_begin, raise ? raise_end : carve_end, section_blocks.data(), summary));
+		section.Assign(section_blocks.data(), db);
 	}
-	generated_ = true;
+	summary.solid_top = solid_end - 1;
+}
+
+void Chunk::GenerateSurface()
+{
+	const WorldGenerator& world_generator = chunk_manager_.GetWorldGenerator();
+	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
+	const ColumnHeights& heights = *column_heights_;
+
+	// summary already counts with these blocks (GenerateTerrain), so they are placed directly into sections,
+	// band is only few blocks high, so they are set one by one
+	std::array<BlockSpan, MAX_COLUMN_SPANS> spans;
+	for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+		for (int x = 0; x < CHUNK_SIZE_X; ++x)
+		{
+			const HeightPayload& height = heights[x + z * CHUNK_SIZE_X];
+			const int surface_begin = world_generator.GetColumnStoneTop(height) + 1;
+			const int surface_end = std::min(height.height + 1, CHUNK_SIZE_Y);
+			const int count = world_generator.GetColumnSpans(height, spans.data());
+			for (int i = 0; i < count; ++i)
+				for (int y = std::max(spans[i].y_begin, surface_begin); y < std::min(spans[i].y_end, surface_end); ++y)
+				{
+					const BlockId block = spans[i].block == BlockId::Stone && y % 32 == 0 ? BlockId::Wood : spans[i].block;
+					sections_[y / SECTION_SIZE].SetBlock(GetIndex(x, y, z), block, db);
+				}
+		}
+}
+
+// Every chunk places parts of all trees reaching into it, trees of neighbours included (tree is at most TREE_RADIUS wide from trunk),
+// chunk writes only its own blocks, so all chunks can be decorated in parallel and result does not depend on order.
+void Chunk::GenerateDecoration()
+{
+	const int TREE_RADIUS = 2;
+	const int TRUNK_HEIGHT = 5;
+	static_assert(TREE_RADIUS < CHUNK_SIZE_X && TREE_RADIUS < CHUNK_SIZE_Z, "tree reaches only direct neighbours");
+
+	GenerationContext& context = GenerationContext::ForCurrentThread();
+	std::vector<DecorationTree>& trees = context.trees;
+	trees.clear();
+	for (int neighbour_z = -1; neighbour_z <= 1; ++neighbour_z)
+		for (int neighbour_x = -1; neighbour_x <= 1; ++neighbour_x)
+		{
+			const Chunk* chunk = neighbour_x == 0 && neighbour_z == 0 ? this :
+				chunk_manager_.FindChunk(global_position_.x + neighbour_x, global_position_.z + neighbour_z);
+			if (chunk == nullptr)
+				continue;
+			const HeightPayload* heights = chunk->GetColumnHeights() ? chunk->GetColumnHeights()->data() : nullptr;
+			if (heights == nullptr && chunk->GetStage() == GenerationStage::Lit)
+			{
+				// baked chunk is loaded lit, without column heights, its trees reaching here are found again
+				std::vector<HeightPayload>& neighbour_heights = context.neighbour_heights;
+				neighbour_heights.resize(CHUNK_SIZE_X * CHUNK_SIZE_Z);
+				const glm::i64vec3 position = chunk->GetGlobalPosition();
+				chunk_manager_.GetWorldGenerator().GenerateHeights((int)position.x * CHUNK_SIZE_X, (int)position.z * CHUNK_SIZE_Z,
+					CHUNK_SIZE_X, CHUNK_SIZE_Z, neighbour_heights.data(), context);
+				heights = neighbour_heights.data();
+			}
+			if (heights == nullptr)
+				continue;
+			for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+				for (int x = 0; x < CHUNK_SIZE_X; ++x)
+				{
+					const int local_x = x + neighbour_x * CHUNK_SIZE_X;
+					const int local_z = z + neighbour_z * CHUNK_SIZE_Z;
+					const HeightPayload& height = heights[x + z * CHUNK_SIZE_X];
+					if (height.should_place_tree && local_x >= -TREE_RADIUS && local_x < CHUNK_SIZE_X + TREE_RADIUS &&
+						local_z >= -TREE_RADIUS && local_z < CHUNK_SIZE_Z + TREE_RADIUS)
+						trees.push_back({ local_x, local_z, height.height });
+				}
+		}
+
+	// leaves only into air, trunks over anything but terrain, so overlapping trees give same blocks in any order
+	for (const DecorationTree& tree : trees)
+		for (int dy = TRUNK_HEIGHT - 1; dy <= TRUNK_HEIGHT + 2; ++dy)
+		{
+			const int radius = dy < TRUNK_HEIGHT + 1 ? TREE_RADIUS : 1;
+			for (int dz = -radius; dz <= radius; ++dz)
+				for (int dx = -radius; dx <= radius; ++dx)
+				{
+					// no corners, top layer is a cross
+					if ((std::abs(dx) == radius && std::abs(dz) == radius) && (radius == TREE_RADIUS || dy == TRUNK_HEIGHT + 2))
+						continue;
+					const int x = tree.x + dx, y = tree.base + dy, z = tree.z + dz;
+					if (!OutOfBounds(x, y, z) && GetBlock(x, y, z) == BlockId::Air)
+						PlaceBlock(x, y, z, BlockId::Leaves);
+				}
+		}
+	for (const DecorationTree& tree : trees)
+		for (int dy = 1; dy <= TRUNK_HEIGHT; ++dy)
+			if (!OutOfBounds(tree.x, tree.base + dy, tree.z))
+			{
+				const BlockId block = GetBlock(tree.x, tree.base + dy, tree.z);
+				if (block == BlockId::Air || block == BlockId::Leaves)
+					PlaceBlock(tree.x, tree.base + dy, tree.z, BlockId::Wood);
+			}
+}
+
+// SetBlock for generation, chunk is not meshed yet so nothing gets dirty
+void Chunk::PlaceBlock(int x, int y, int z, BlockId block)
+{
+	sections_[y / SECTION_SIZE].SetBlock(GetIndex(x, y, z), block, chunk_manager_.GetBlockDatabase());
+	UpdateHeightSummary(x, y, z, block);
 }
 
 void Chunk::Delete()
@@ -67,6 +439,7 @@ void Chunk::Delete()
 	blased_ = false;
 #endif
 	meshed_ = false;
+	dirty_sections_ = 0;
 	//std::cout << "Freeing Blas X: " << this->global_position_.x << " Y: " << this->global_position_.y << " Z: " << this->global_position_.z << std::endl;
 }
 
@@ -76,11 +449,24 @@ void Chunk::SetBlock(int x, int y, int z, BlockId block)
 	if (OutOfBounds(x, y, z)) 
 		assert(false);
 
-	blocks_[GetIndex(x, y, z)] = block;
-	meshed_ = false;
-#ifdef VULKAN
-	blased_ = false;
-#endif
+	sections_[y / SECTION_SIZE].SetBlock(GetIndex(x, y, z), block, chunk_manager_.GetBlockDatabase());
+	UpdateHeightSummary(x, y, z, block);
+
+	// block is visible only from its own section and from the one next to it when it lies on section border,
+	// neighbour chunks are handled by ChunkManager::SetBlock
+	const int section_y = y / SECTION_SIZE;
+	MarkSectionDirty(section_y);
+	if (y % SECTION_SIZE == 0 && section_y > 0)
+		MarkSectionDirty(section_y - 1);
+	if (y % SECTION_SIZE == SECTION_SIZE - 1 && section_y + 1 < CHUNK_SECTION_COUNT)
+		MarkSectionDirty(section_y + 1);
+}
+
+// not meshed chunk will be meshed whole anyway
+void Chunk::MarkSectionDirty(int section_y)
+{
+	if (meshed_)
+		dirty_sections_ |= 1 << section_y;
 }
 
 BlockId Chunk::GetBlock(int x, int y, int z) const
@@ -88,12 +474,157 @@ BlockId Chunk::GetBlock(int x, int y, int z) const
 	if (OutOfBounds(x, y, z)) 
 		return chunk_manager_.GetBlock(x + CHUNK_SIZE_X * global_position_.x, y, z + CHUNK_SIZE_Z * global_position_.z);
 
-	return blocks_[GetIndex(x, y, z)];
+	return sections_[y / SECTION_SIZE].GetBlock(GetIndex(x, y, z));
+}
+
+void Chunk::UpdateHeightSummary(int x, int y, int z, BlockId block)
+{
+	HeightSummary& summary = height_summary_;
+	int16_t& column_height = summary.heightmap[x + z * CHUNK_SIZE_X];
+
+	if (chunk_manager_.GetBlockDatabase().GetBlockData(block).isTransparent())
+		summary.solid_top = std::min(summary.solid_top, y - 1);
+
+	if (block != BlockId::Air)
+	{
+		summary.min_y = std::min(summary.min_y, y);
+		summary.max_y = std::max(summary.max_y, y);
+		column_height = std::max<int16_t>(column_height, y);
+		if (block == BlockId::Water)
+		{
+			summary.water_min_y = std::min(summary.water_min_y, y);
+			summary.water_max_y = std::max(summary.water_max_y, y);
+		}
+	}
+	else if (y == column_height)
+	{
+		// top of column removed, find new one
+		do
+			--column_height;
+		while (column_height >= 0 && GetBlock(x, column_height, z) == BlockId::Air);
+	}
+}
+
+template<typename T>
+static void AppendBaked(std::vector<uint8_t>& record, T value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	record.insert(record.end(), bytes, bytes + sizeof(T));
 }
 
+template<typename T>
+static bool ConsumeBaked(const uint8_t*& record, const uint8_t* end, T& value)
+{
+	if (end - record < (ptrdiff_t)sizeof(T))
+		return false;
+	std::memcpy(&value, record, sizeof(T));
+	record += sizeof(T);
+	return true;
+}
+
+// runs go through section layout (GetIndex), so uniform layers and stone under terrain are few runs
+void Chunk::WriteBaked(std::vector<uint8_t>& record) const
+{
+	assert(stage_ == GenerationStage::Lit);
+	record.clear();
+	const HeightSummary& summary = height_summary_;
+	for (int value : { summary.min_y, summary.max_y, summary.solid_top, summary.water_min_y, summary.water_max_y })
+		AppendBaked<int32_t>(record, value);
+	for (int16_t height : summary.heightmap)
+		AppendBaked<int16_t>(record, height);
+
+	for (const ChunkSection& section : sections_)
+	{
+		const size_t run_count_at = record.size();
+		AppendBaked<uint16_t>(record, 0);
+		uint16_t run_count = 0;
+		for (int begin = 0; begin < SECTION_VOLUME;)
+		{
+			const BlockId block = section.GetBlock(begin);
+			int end = begin + 1;
+			while (end < SECTION_VOLUME && section.GetBlock(end) == block)
+				++end;
+			AppendBaked<uint8_t>(record, static_cast<uint8_t>(block));
+			AppendBaked<uint16_t>(record, end - begin);
+			++run_count;
+			begin = end;
+		}
+		std::memcpy(&record[run_count_at], &run_count, sizeof(run_count));
+	}
+}
+
+// whole record is decoded and checked before anything is assigned, so broken record leaves chunk as it was
+bool Chunk::ReadBaked(const uint8_t* record, size_t size)
+{
+	const uint8_t* end = record + size;
+	HeightSummary summary;
+	int32_t bounds[5] = {};
+	for (int32_t& value : bounds)
+		if (!ConsumeBaked(record, end, value))
+			return false;
+	for (int16_t& height : summary.heightmap)
+		if (!ConsumeBaked(record, end, height))
+			return false;
+	summary.min_y = bounds[0];
+	summary.max_y = bounds[1];
+	summary.solid_top = bounds[2];
+	summary.water_min_y = bounds[3];
+	summary.water_max_y = bounds[4];
+
+	std::vector<BlockRun>& runs = GenerationContext::ForCurrentThread().runs;
+	runs.clear();
+	std::array<uint16_t, CHUNK_SECTION_COUNT> run_counts = {};
+	for (uint16_t& run_count : run_counts)
+	{
+		if (!ConsumeBaked(record, end, run_count) || run_count > SECTION_VOLUME)
+			return false;
+		int filled = 0;
+		for (int run = 0; run < run_count; ++run)
+		{
+			uint8_t block = 0;
+			uint16_t length = 0;
+			if (!ConsumeBaked(record, end, block) || !ConsumeBaked(record, end, length) ||
+				block >= static_cast<uint8_t>(BlockId::NUM_TYPES) || length == 0 || filled + length > SECTION_VOLUME)
+				return false;
+			runs.push_back({ static_cast<BlockId>(block), length });
+			filled += length;
+		}
+		if (filled != SECTION_VOLUME)
+			return false;
+	}
+
+	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
+	const BlockRun* section_runs = runs.data();
+	for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+	{
+		sections_[section_y].AssignRuns(section_runs, run_counts[section_y], db);
+		section_runs += run_counts[section_y];
+	}
+	height_summary_ = summary;
+	column_heights_.reset();
+	stage_ = GenerationStage::Lit;
+	return true;
+}
+
+size_t Chunk::MemoryUsage() const
+{
+	size_t memory = sizeof(*this) - sizeof(sections_) + (column_heights_ ? sizeof(ColumnHeights) : 0);
+	for (const auto& section : sections_)
+		memory += section.MemoryUsage();
+	if (section_vertices_)
+	{
+		memory += sizeof(*section_vertices_);
+		for (const auto& section : *section_vertices_)
+			for (const auto& layer : section)
+				memory += layer.capacity() * sizeof(uint32_t);
+	}
+	return memory;
+}
+
+// index inside section, section itself is picked by y / SECTION_SIZE
 inline int Chunk::GetIndex(int x, int y, int z) const
 {
-	return x + z * CHUNK_SIZE_X + y * (CHUNK_SIZE_X * CHUNK_SIZE_Z);
+	return x + z * CHUNK_SIZE_X + (y % SECTION_SIZE) * (CHUNK_SIZE_X * CHUNK_SIZE_Z);
 }
 
 inline bool Chunk::OutOfBounds(int x, int y, int z) const
@@ -121,128 +652,104 @@ inline bool Chunk::OutOfBounds(int x, int y, int z) const
 // As someone smart said: "premature optimization is the root of all evil,", 
 // so I will wait to optimize further until most features are added or until it becomes a real bottleneck.
 // It also include using better algorithm (improving what we have) or moving into Greedy Meshing
-void Chunk::BuildMesh()
+
+// Greedy meshing is selectable by MeshingMode (ChunkMesher.h), scratch memory is reused through MeshingArena,
+// per chunk timing is measured by benchmark (benchmark/ChunkBenchmark.cpp)
+void Chunk::BuildMesh(int lod)
+{
+	lod_ = lod;
+	// chunks around player keep CPU copy of their mesh, so even their first edit remeshes only dirty sections,
+	// most chunks are never edited, they do not keep it
+	if (lod_ == 1 && chunk_manager_.InEditArea(global_position_.x, global_position_.z))
+	{
+		if (!section_vertices_)
+			section_vertices_ = std::make_unique<std::array<LayeredVertices, CHUNK_SECTION_COUNT>>();
+	}
+	else
+		section_vertices_.reset();
+	MeshSections(ChunkSnapshot::ALL_SECTIONS);
+}
+
+// first edit of chunk without section cache meshes whole chunk into it, following ones rebuild only dirty sections
+void Chunk::UpdateMesh()
 {
-	static auto total = high_resolution_clock::now() - high_resolution_clock::now();
-	static int avg_ctr = 0;
-	auto start = high_resolution_clock::now();
+	if (!meshed_ || dirty_sections_ == 0)
+		return;
+	uint16_t sections = dirty_sections_;
+	if (!section_vertices_)
+	{
+		section_vertices_ = std::make_unique<std::array<LayeredVertices, CHUNK_SECTION_COUNT>>();
+		sections = ChunkSnapshot::ALL_SECTIONS;
+	}
+	Delete();
+	MeshSections(sections);
+}
 
+void Chunk::MeshSections(uint16_t sections)
+{
 	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
 
-	const float x_offset = global_position_.x * CHUNK_SIZE_X;
-	const float y_offset = global_position_.y * CHUNK_SIZE_Y;
-	const float z_offset = global_position_.z * CHUNK_SIZE_Z;
-
-	std::vector<float> vertices;
-	std::vector<unsigned int> indices;
-	vertices.reserve(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z * 4 * 5);//TODO
-	indices.reserve(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z * 6);//TODO
+	// vertices are chunk local, chunk position is applied by TLAS instance transform / mesh_position uniform
+	const glm::vec3 position(global_position_.x * CHUNK_SIZE_X, global_position_.y * CHUNK_SIZE_Y, global_position_.z * CHUNK_SIZE_Z);
 
-	AdjacentBlockPositions neighbour;
-	unsigned int indexIndex = 0;
+	std::unique_ptr<MeshingArena> fresh_arena;	// allocated and freed every call, only for comparison
+	if (!chunk_manager_.UsesMeshingArena())
+		fresh_arena = std::make_unique<MeshingArena>();
+	MeshingArena& arena = fresh_arena ? *fresh_arena : MeshingArena::ForCurrentThread();
+	// all reads below go only through snapshot (no bounds checks, no ChunkManager lookups for blocks on chunk border)
+	arena.snapshot.Capture(*this, chunk_manager_, sections, lod_);
 
-	for (int y = 0; y < CHUNK_SIZE_Y; ++y)
-		for (int z = 0; z < CHUNK_SIZE_Z; ++z)
-			for (int x = 0; x < CHUNK_SIZE_X; ++x)
+	// LOD relies on greedy merging of downsampled cells, naive would still emit face per block
+	ChunkMesher mesher(db, lod_ > 1 ? MeshingMode::Greedy : chunk_manager_.GetMeshingMode(), chunk_manager_.UsesBakedAo(), arena.mesher_scratch);
+	if (section_vertices_)
+	{
+		for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+			if (sections & (1 << section_y))
 			{
-				BlockId block = GetBlock(x, y, z);
-
-				// TODO when split into solid and transparent skip when transparent
-				if (block == BlockId::Air)
-					continue;
-
-				const auto& blockData = db.GetBlockData(block);
-
-				//TODO get some data?
-				neighbour.update(x, y, z);
-
-				//ADD 6 faces if...
-				//if (IsVisible(neighbour.down.x, neighbour.down.y, neighbour.down.z))
-				if (IsVisible(blockData, neighbour.down.x, neighbour.down.y, neighbour.down.z))
-					AddFace(vertices, indices, Face::BOTTOM_FACE, blockData.getUVBottom(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
-				//if (IsVisible(neighbour.up.x, neighbour.up.y, neighbour.up.z))
-				if (IsVisible(blockData, neighbour.up.x, neighbour.up.y, neighbour.up.z))
-					AddFace(vertices, indices, Face::TOP_FACE, blockData.getUVTop(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
-				//if (IsVisible(neighbour.back.x, neighbour.back.y, neighbour.back.z))
-				if (IsVisible(blockData, neighbour.back.x, neighbour.back.y, neighbour.back.z))
-					AddFace(vertices, indices, Face::BACK_FACE, blockData.getUVSides(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
-				//if (IsVisible(neighbour.front.x, neighbour.front.y, neighbour.front.z))
-				if (IsVisible(blockData, neighbour.front.x, neighbour.front.y, neighbour.front.z))
-					AddFace(vertices, indices, Face::FRONT_FACE, blockData.getUVSides(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
-				//if (IsVisible(neighbour.left.x, neighbour.left.y, neighbour.left.z))
-				if (IsVisible(blockData, neighbour.left.x, neighbour.left.y, neighbour.left.z))
-					AddFace(vertices, indices, Face::LEFT_FACE, blockData.getUVSides(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
-				//if (IsVisible(neighbour.right.x, neighbour.right.y, neighbour.right.z))
-				if (IsVisible(blockData, neighbour.right.x, neighbour.right.y, neighbour.right.z))
-					AddFace(vertices, indices, Face::RIGHT_FACE, blockData.getUVSides(), { x_offset + x, y_offset + y, z_offset + z }, indexIndex);
+				for (auto& layer : (*section_vertices_)[section_y])
+					layer.clear();
+				mesher.BuildSection(arena.snapshot, section_y, (*section_vertices_)[section_y]);
 			}
+	}
+	else
+	{
+		for (auto& layer : arena.layers)
+			layer.clear();
+		mesher.Build(arena.snapshot, arena.layers);
+	}
+	dirty_sections_ = 0;
+
+	// mesh / BLAS is still one per chunk, layers are concatenated one after another (cached sections in order)
+	std::vector<uint32_t>& vertices = arena.vertices;
+	vertices.clear();
+	MeshLayerOffsets layer_offsets;
+	for (int layer = 0; layer < MESH_LAYER_COUNT; ++layer)
+	{
+		layer_offsets[layer] = (uint32_t)vertices.size();
+		if (section_vertices_)
+			for (const auto& section : *section_vertices_)
+				vertices.insert(vertices.end(), section[layer].begin(), section[layer].end());
+		else
+			vertices.insert(vertices.end(), arena.layers[layer].begin(), arena.layers[layer].end());
+	}
+	layer_offsets[MESH_LAYER_COUNT] = (uint32_t)vertices.size();
+	assert(vertices.size() / 4 <= (size_t)ChunkVertex::MAX_QUADS);	// shared quad index buffer covers whole mesh, all layers
+
 #ifdef OPENGL
-	mesh_ = new Mesh(vertices, indices);
+	mesh_ = new Mesh(vertices, position);
 #endif
 #ifdef VULKAN
-	acceleration_structure_ = chunk_manager_.GetRenderer().BuildBlas(vertices, indices);
+	acceleration_structure_ = chunk_manager_.GetRenderer().BuildBlas(vertices, layer_offsets, position);
+#endif
+#ifdef HEADLESS
+	vertex_count_ = vertices.size();
 #endif
 	meshed_ = true;
-	//std::cout << "Allocating Blas X: " << this->global_position_.x << " Y: " << this->global_position_.y << " Z: " << this->global_position_.z << std::endl;
-	auto stop = high_resolution_clock::now();
-	auto duration = duration_cast<microseconds>(stop - start);
-	std::cout << "current: " << duration.count() << std::endl;
-	total += stop - start;
-	std::cout << "total: " << duration_cast<milliseconds>(total).count() << std::endl;
-	++avg_ctr;
-	std::cout << "average: " << duration_cast<microseconds>(total / avg_ctr).count() << std::endl;
-}
-
-////TODO name
-//bool Chunk::IsVisible(int x, int y, int z) const
-//{
-//	// TODO when split into solid and transparent
-//	// for some reason this is slightly faster than: return GetBlock(x, y, z) == BlockId::Air;
-//	if (GetBlock(x, y, z) == BlockId::Air)
-//		return true;
-//	return false;
-//}
-
-bool Chunk::IsVisible(const Block& block, int x, int y, int z) const
-{
-	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
-	Block neighbour_block = db.GetBlockData(GetBlock(x, y, z));
-
-	if (neighbour_block.isTransparent() && block.getId() != GetBlock(x, y, z))
-		return true;
-	return false;
-}
-
-void Chunk::AddFace(std::vector<float>& vertices, std::vector<unsigned int>& indices, Face face, const std::array<glm::vec2, 4>& uv, const glm::vec3& offset, unsigned int& indexIndex)
-{
-	const BlockDatabase& db = chunk_manager_.GetBlockDatabase();
-	const auto& face_vert = db.GetFaceVertices(face);
-
-	for (int i = 0; i < 4; ++i)
-	{
-		vertices.emplace_back(face_vert[i].x + offset.x);
-		vertices.emplace_back(face_vert[i].y + offset.y);
-		vertices.emplace_back(face_vert[i].z + offset.z);
-		vertices.emplace_back(uv[i].x);
-		vertices.emplace_back(uv[i].y);
-		#ifdef OPENGL
-		vertices.emplace_back(db.GetFaceLighting(face));	//temporary simple lighting
-		#endif
-	}
-
-	indices.emplace_back(indexIndex);
-	indices.emplace_back(indexIndex + 1);
-	indices.emplace_back(indexIndex + 2);
-	indices.emplace_back(indexIndex + 2);
-	indices.emplace_back(indexIndex + 3);
-	indices.emplace_back(indexIndex);
-
-	indexIndex += 4;
 }
 
 #ifdef OPENGL
-void Chunk::Draw() const
+void Chunk::Draw(Shader& shader) const
 {
-	mesh_->Draw();
+	mesh_->Draw(shader);
 }
 #endif
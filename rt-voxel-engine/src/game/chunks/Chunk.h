@@ -9,33 +9,47 @@
 #include "renderer-vulkan-rt/RendererRT.h"
 #endif
 #include "ChunkManager.h"
+#include "ChunkSection.h"
+#include "GenerationStage.h"
+#include "WorldGenerator.h"
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 class ChunkManager;
+class ChunkSnapshot;
 
 const int CHUNK_SIZE_X = 16;
 const int CHUNK_SIZE_Y = 256;
 const int CHUNK_SIZE_Z = 16;
 const int CHUNK_VOLUME = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+const int CHUNK_SECTION_COUNT = CHUNK_SIZE_Y / SECTION_SIZE;
 
-struct AdjacentBlockPositions
+using ColumnHeights = std::array<HeightPayload, CHUNK_SIZE_X * CHUNK_SIZE_Z>;
+
+// Vertical bounds of chunk content, filled by Chunk::Generate. Block edits keep heightmap exact,
+// other bounds are only widened by edits, so they are always safe to restrict loops with, but may be loose.
+struct HeightSummary
 {
-	inline void update(int x, int y, int z)
+	int min_y;			// lowest non air block, CHUNK_SIZE_Y for empty chunk
+	int max_y;			// highest non air block, -1 for empty chunk
+	int solid_top;		// layers 0 ... solid_top contain only non transparent blocks, nothing there can be visible from inside of chunk
+	int water_min_y;	// water_min_y > water_max_y when there is no water
+	int water_max_y;
+	std::array<int16_t, CHUNK_SIZE_X * CHUNK_SIZE_Z> heightmap;	// highest non air block in column, -1 for empty column
+
+	void Reset()
 	{
-		up =	{ x,		y + 1,  z };
-		down =	{ x,		y - 1,  z };
-		left =	{ x - 1,	y,      z };
-		right = { x + 1,	y,      z };
-		front = { x,		y,      z + 1 };
-		back =	{ x,		y,      z - 1 };
+		min_y = CHUNK_SIZE_Y;
+		max_y = -1;
+		solid_top = -1;
+		water_min_y = CHUNK_SIZE_Y;
+		water_max_y = -1;
+		heightmap.fill(-1);
 	}
-
-	glm::ivec3 up;
-	glm::ivec3 down;
-	glm::ivec3 left;
-	glm::ivec3 right;
-	glm::ivec3 front;
-	glm::ivec3 back;
+	inline int GetHeight(int x, int z) const { return heightmap[x + z * CHUNK_SIZE_X]; }
+	inline bool HasWater() const { return water_min_y <= water_max_y; }
 };
 
 class Chunk
@@ -47,27 +61,57 @@ public:
 
 	void SetBlock(int x, int y, int z, BlockId block);
 	BlockId GetBlock(int x, int y, int z) const;
-	void Generate();
-	void BuildMesh();
-	const bool Genereted() const { return generated_; };
+	void GenerateStage(GenerationStage stage);	// next stage only, neighbours must be ready for it, see GenerationStage
+	// baked chunk (BakedRegion record): height summary, then blocks of every section as runs, only lit chunk can be baked
+	void WriteBaked(std::vector<uint8_t>& record) const;
+	bool ReadBaked(const uint8_t* record, size_t size);	// chunk becomes lit, false (and chunk stays empty) when record is broken
+	void BuildMesh(int lod = 1);	// lod is 1 (full detail), 2, 4 or 8, see ChunkSnapshot
+	// rebuilds only sections marked dirty by block edits, whole chunk mesh (BLAS) is then assembled from cached sections
+	void UpdateMesh();
+	void MarkSectionDirty(int section_y);
+	inline bool HasDirtySections() const { return dirty_sections_ != 0; };
+	inline bool HasSectionCache() const { return section_vertices_ != nullptr; };
+	inline void ReleaseSectionCache() { section_vertices_.reset(); };	// next edit meshes whole chunk again
+	const bool Genereted() const { return stage_ == GenerationStage::Lit; };
+	inline GenerationStage GetStage() const { return stage_; };
+	// from terrain stage, decoration of neighbours reads them, freed once chunk is lit (then all neighbours are decorated)
+	inline const ColumnHeights* GetColumnHeights() const { return column_heights_.get(); };
 	const bool Meshed() const { return meshed_; };
+	inline int GetLod() const { return lod_; };
+	inline const ChunkSection& GetSection(int section_y) const { return sections_[section_y]; };
+	inline glm::i64vec3 GetGlobalPosition() const { return global_position_; };
+	inline const HeightSummary& GetHeightSummary() const { return height_summary_; };
+	size_t MemoryUsage() const;
 #ifdef OPENGL
-	void Draw() const;
+	void Draw(Shader& shader) const;
 #endif
 #ifdef VULKAN
 	const bool Blased();
 	const BottomLevelAccelerationStructure& GetBLAS() const { return acceleration_structure_; };
 #endif
+#ifdef HEADLESS
+	inline size_t GetVertexCount() const { return vertex_count_; };	// of last built mesh
+#endif
 private:
 	inline int GetIndex(int x, int y, int z) const;
 	inline bool OutOfBounds(int x, int y, int z) const;
-	void AddFace(std::vector<float>& vertices, std::vector<unsigned int>& indices, Face face, const std::array<glm::vec2, 4>& uv, const glm::vec3& offset, unsigned int& indexIndex);
-	//bool IsVisible(int x, int y, int z) const;
-	bool IsVisible(const Block& block, int x, int y, int z) const;
+	void UpdateHeightSummary(int x, int y, int z, BlockId block);
+	void GenerateTerrain();
+	void GenerateSurface();
+	void GenerateDecoration();
+	void PlaceBlock(int x, int y, int z, BlockId block);
+	void MeshSections(uint16_t sections);	// bit per section
 
 	glm::i64vec3 global_position_;	//TODO we using only x and z components in future maybe we will use y, if not think about refactor
-	BlockId blocks_[CHUNK_VOLUME];
-	bool generated_;
+	std::array<ChunkSection, CHUNK_SECTION_COUNT> sections_;
+	HeightSummary height_summary_;
+	// mesh cache, so edit does not remesh whole chunk, chunks in edit area (ChunkManager::InEditArea) and edited ones have it
+	std::unique_ptr<std::array<LayeredVertices, CHUNK_SECTION_COUNT>> section_vertices_;
+	uint16_t dirty_sections_;
+	int lod_;
+	static_assert(CHUNK_SECTION_COUNT <= 16, "dirty_sections_ has bit per section");
+	GenerationStage stage_;
+	std::unique_ptr<ColumnHeights> column_heights_;
 	bool meshed_;
 #ifdef OPENGL
 	Mesh* mesh_;
@@ -75,6 +119,9 @@ private:
 #ifdef VULKAN
 	bool blased_;
 	BottomLevelAccelerationStructure acceleration_structure_;
+#endif
+#ifdef HEADLESS
+	size_t vertex_count_;
 #endif
 	ChunkManager& chunk_manager_; //TODO smart pointer?
 };
@@ -1,9 +1,19 @@
 #include "ChunkManager.h"
+#include "config.h"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 using namespace std::chrono;
 
-#ifdef OPENGL
+static const size_t BAKED_REGIONS = 16;	// kept in memory, area of render distance 16 spans at most 9 regions
+
+static long long int FloorDiv(long long int a, long long int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+#if defined(OPENGL) || defined(HEADLESS)
 ChunkManager::ChunkManager(int render_distance, glm::vec3 player_position, int world_generator_seed)
 	:block_database_(), world_generator_(world_generator_seed)
 #endif
@@ -12,43 +22,40 @@ ChunkManager::ChunkManager(int render_distance, glm::vec3 player_position, int w
 	:block_database_(), world_generator_(world_generator_seed), renderer_(renderer)
 #endif
 {
+	meshing_mode_ = GREEDY_MESHING ? MeshingMode::Greedy : MeshingMode::Naive;
+	meshing_arena_ = MESHING_ARENA;
+	baked_ao_ = BAKED_AO;
+	edit_cache_distance_ = EDIT_CACHE_DISTANCE;
 	render_distance_ = render_distance;
-	generation_distance_ = render_distance + 1;
-	chunks_dimension_length_ = 2 * generation_distance_ + 1;
-	chunks_.reserve(chunks_dimension_length_ * chunks_dimension_length_);
+	generation_distance_ = render_distance + GENERATION_MARGIN;
 	chunk_offset_ = { floor(player_position.x / (float)CHUNK_SIZE_X), 0, floor(player_position.z / (float)CHUNK_SIZE_Z) };
-	internal_array_offset_ = glm::ivec3(0, 0, 0);
+	loaded_baked_chunks_ = 0;
 }
 
 ChunkManager::~ChunkManager()
 {
-	for (int z = -generation_distance_; z <= generation_distance_; ++z)
-		for (int x = -generation_distance_; x <= generation_distance_; ++x)
-			if (chunks_[GetChunkIndex(x, z)].Meshed())
-				chunks_[GetChunkIndex(x, z)].Delete();
+	chunks_.ForEach([](Chunk& chunk) {
+		if (chunk.Meshed())
+			chunk.Delete();
+	});
 }
 
 void ChunkManager::GenerateChunks()
 {
-	for (int z = -generation_distance_ + chunk_offset_.z; z <= generation_distance_ + chunk_offset_.z; ++z)
-		for (int x = -generation_distance_ + chunk_offset_.x; x <= generation_distance_ + chunk_offset_.x; ++x)
-			chunks_.emplace_back(Chunk(glm::i64vec3(x, 0.0, z), *this));
-
 	auto start = high_resolution_clock::now();
 
-#ifndef _DEBUG
-#pragma omp parallel for collapse(2)
-#endif
-	for (int z = -generation_distance_; z <= generation_distance_; ++z)
-		for (int x = -generation_distance_; x <= generation_distance_; ++x)
-			chunks_[GetChunkIndex(x, z)].Generate();
+	GenerateArea(chunk_offset_.x, chunk_offset_.z, render_distance_);
 
 	auto stop = high_resolution_clock::now();
 	auto duration = duration_cast<milliseconds>(stop - start);
 	std::cout << "Generation time: " << duration.count() << std::endl;
+	if (!baked_directory_.empty())
+		std::cout << "Baked chunks loaded: " << loaded_baked_chunks_ << std::endl;
 
+	size_t chunks_memory = 0;
+	chunks_.ForEach([&chunks_memory](const Chunk& chunk) { chunks_memory += chunk.MemoryUsage(); });
+	std::cout << "Chunks memory (KiB): " << chunks_memory / 1024 << " (" << chunks_memory / chunks_.Size() << " bytes per chunk)" << std::endl;
 
-	std::cout.setstate(std::ios_base::failbit);
 	start = high_resolution_clock::now();
 
 	// TODO instead of this we should have func which build one(and more but not all at one iteration) chunk,
@@ -60,11 +67,10 @@ void ChunkManager::GenerateChunks()
 #endif
 	for (int z = -render_distance_; z <= render_distance_; ++z)
 		for (int x = -render_distance_; x <= render_distance_; ++x)
-			chunks_[GetChunkIndex(x, z)].BuildMesh();
+			FindChunk(x + chunk_offset_.x, z + chunk_offset_.z)->BuildMesh(GetLod(x + chunk_offset_.x, z + chunk_offset_.z));
 
 	stop = high_resolution_clock::now();
 	duration = duration_cast<milliseconds>(stop - start);
-	std::cout.clear();
 	std::cout << "Building mesh time (parallel, host only): " << duration.count() << std::endl;
 }
 
@@ -73,44 +79,34 @@ void ChunkManager::UpdateCenter(glm::vec3 player_position)
 	glm::i64vec3 new_chunk_offset = { floor(player_position.x / (float)CHUNK_SIZE_X), 0, floor(player_position.z / (float)CHUNK_SIZE_Z) };
 	if (new_chunk_offset != chunk_offset_)
 	{
-		glm::ivec3 direction = new_chunk_offset - chunk_offset_;
+		glm::i64vec3 old_chunk_offset = chunk_offset_;
 		chunk_offset_ = new_chunk_offset;
-		internal_array_offset_ = (internal_array_offset_ + direction + chunks_dimension_length_) % chunks_dimension_length_;
-
-		int x_dir = (0 < direction.x) - (direction.x < 0);
-		int x_range = direction.x;
-		int z_dir = (0 < direction.z) - (direction.z < 0);
-		int z_range = direction.z;
-
-		if (x_dir)
-			for (int x = x_dir * generation_distance_; x != x_dir * generation_distance_ - x_range; x = x - x_dir)
-				for (int z = -generation_distance_; z <= generation_distance_; ++z)
-				{
-					if (chunks_[GetChunkIndex(x, z)].Meshed())
-						chunks_[GetChunkIndex(x, z)].Delete();
-					chunks_[GetChunkIndex(x, z)].ReuseChunk(glm::i64vec3(x + chunk_offset_.x, 0, z + chunk_offset_.z));
-					chunks_[GetChunkIndex(x, z)].Generate();
-				}
-		if (z_dir)
-			for (int z = z_dir * generation_distance_; z != z_dir * generation_distance_ - z_range; z = z - z_dir)
-				for (int x = -generation_distance_; x <= generation_distance_; ++x)
-				{
-					if (chunks_[GetChunkIndex(x, z)].Meshed())
-						chunks_[GetChunkIndex(x, z)].Delete();
-					chunks_[GetChunkIndex(x, z)].ReuseChunk(glm::i64vec3(x + chunk_offset_.x, 0, z + chunk_offset_.z));
-					chunks_[GetChunkIndex(x, z)].Generate();
-				}
-
-		if (x_dir)
-			for (int x = x_dir * render_distance_; x != x_dir * render_distance_ - x_range; x = x - x_dir)
-				for (int z = -render_distance_; z <= render_distance_; ++z)
-					if (chunks_[GetChunkIndex(x, z)].Meshed() == false)
-						chunks_[GetChunkIndex(x, z)].BuildMesh();
-		if (z_dir)
-			for (int z = z_dir * render_distance_; z != z_dir * render_distance_ - z_range; z = z - z_dir)
-				for (int x = -render_distance_; x <= render_distance_; ++x)
-					if (chunks_[GetChunkIndex(x, z)].Meshed() == false)
-						chunks_[GetChunkIndex(x, z)].BuildMesh();
+
+		// works for any move, also for jumps further than generation distance
+		for (long long int z = -generation_distance_ + old_chunk_offset.z; z <= generation_distance_ + old_chunk_offset.z; ++z)
+			for (long long int x = -generation_distance_ + old_chunk_offset.x; x <= generation_distance_ + old_chunk_offset.x; ++x)
+				if (!InGenerationArea(x, z))
+					UnloadChunk(x, z);
+
+		GenerateArea(chunk_offset_.x, chunk_offset_.z, render_distance_);
+
+		for (long long int z = -render_distance_ + chunk_offset_.z; z <= render_distance_ + chunk_offset_.z; ++z)
+			for (long long int x = -render_distance_ + chunk_offset_.x; x <= render_distance_ + chunk_offset_.x; ++x)
+			{
+				// chunks which moved to another LOD ring are remeshed too, and so are chunks next to them (skirts face only other LOD)
+				Chunk* chunk = FindChunk(x, z);
+				const int lod = GetLod(x, z);
+				const auto ring_changed = [&](long long int chunk_x, long long int chunk_z) { return GetLod(chunk_x, chunk_z, old_chunk_offset) != GetLod(chunk_x, chunk_z); };
+				if (chunk->Meshed() && (chunk->GetLod() != lod || ring_changed(x - 1, z) || ring_changed(x + 1, z) || ring_changed(x, z - 1) || ring_changed(x, z + 1)))
+					chunk->Delete();
+				// chunks which entered edit area are remeshed into section cache, ones which left it drop it
+				else if (chunk->Meshed() && lod == 1 && InEditArea(x, z) && !chunk->HasSectionCache())
+					chunk->Delete();
+				else if (!InEditArea(x, z))
+					chunk->ReleaseSectionCache();
+				if (chunk->Meshed() == false)
+					chunk->BuildMesh(lod);
+			}
 
 #ifdef VULKAN
 		renderer_.ForceRebuild();
@@ -118,77 +114,300 @@ void ChunkManager::UpdateCenter(glm::vec3 player_position)
 	}
 }
 
+Chunk& ChunkManager::LoadChunk(long long int chunk_x, long long int chunk_z)
+{
+	Chunk* chunk = FindChunk(chunk_x, chunk_z);
+	if (chunk && chunk->Genereted())
+		return *chunk;
+	GenerateArea(chunk_x, chunk_z, 0);
+	return *FindChunk(chunk_x, chunk_z);
+}
+
+void ChunkManager::GenerateArea(long long int center_x, long long int center_z, int radius, GenerationStage stage)
+{
+	std::vector<Chunk*> pending;
+	for (int current = static_cast<int>(GenerationStage::Terrain); current <= static_cast<int>(stage); ++current)
+	{
+		// area of each stage is one ring smaller than of previous one, so every chunk in it has neighbours ready
+		const long long int stage_radius = radius + static_cast<int>(stage) - current;
+		const GenerationStage current_stage = static_cast<GenerationStage>(current);
+		pending.clear();
+		for (long long int z = center_z - stage_radius; z <= center_z + stage_radius; ++z)
+			for (long long int x = center_x - stage_radius; x <= center_x + stage_radius; ++x)
+			{
+				Chunk* chunk = FindChunk(x, z);
+				if (chunk == nullptr)
+					chunk = &AddChunk(x, z);
+				if (chunk->GetStage() < current_stage)
+					pending.push_back(chunk);
+			}
+		if (current_stage == GenerationStage::Terrain && !baked_directory_.empty())
+			LoadBakedChunks(pending);
+
+		// stage writes only its own chunk and reads from neighbours only what previous stages made
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < (int)pending.size(); ++i)
+			pending[i]->GenerateStage(current_stage);
+	}
+}
+
+void ChunkManager::SetBakedWorld(const std::string& directory)
+{
+	baked_directory_ = directory;
+	baked_regions_.clear();
+}
+
+void ChunkManager::LoadBakedChunks(std::vector<Chunk*>& pending)
+{
+	// regions are read one by one, records of chunks are decoded in parallel (regions are held until then)
+	std::vector<std::shared_ptr<const BakedRegion>> regions;
+	std::vector<std::pair<Chunk*, std::pair<const uint8_t*, size_t>>> baked;
+	for (Chunk* chunk : pending)
+	{
+		const glm::i64vec3 position = chunk->GetGlobalPosition();
+		const int region_x = (int)FloorDiv(position.x, BakedRegion::REGION_CHUNKS);
+		const int region_z = (int)FloorDiv(position.z, BakedRegion::REGION_CHUNKS);
+		if (regions.empty() || regions.back()->GetRegionX() != region_x || regions.back()->GetRegionZ() != region_z)
+			regions.push_back(FindBakedRegion(region_x, region_z));
+		size_t size;
+		const uint8_t* record = regions.back()->GetChunk((int)(position.x - (long long int)region_x * BakedRegion::REGION_CHUNKS),
+			(int)(position.z - (long long int)region_z * BakedRegion::REGION_CHUNKS), size);
+		if (record)
+			baked.push_back({ chunk, { record, size } });
+	}
+	if (baked.empty())
+		return;
+
+	size_t loaded = 0;
+#ifndef _DEBUG
+#pragma omp parallel for reduction(+:loaded)
+#endif
+	for (int i = 0; i < (int)baked.size(); ++i)
+		loaded += baked[i].first->ReadBaked(baked[i].second.first, baked[i].second.second);
+	loaded_baked_chunks_ += loaded;
+
+	// broken records stay empty and are generated
+	pending.erase(std::remove_if(pending.begin(), pending.end(), [](const Chunk* chunk) { return chunk->GetStage() == GenerationStage::Lit; }),
+		pending.end());
+}
+
+std::shared_ptr<const BakedRegion> ChunkManager::FindBakedRegion(int region_x, int region_z)
+{
+	for (size_t i = 0; i < baked_regions_.size(); ++i)
+		if (baked_regions_[i]->GetRegionX() == region_x && baked_regions_[i]->GetRegionZ() == region_z)
+		{
+			std::shared_ptr<const BakedRegion> region = baked_regions_[i];
+			baked_regions_.erase(baked_regions_.begin() + i);
+			baked_regions_.push_back(region);
+			return region;
+		}
+
+	std::shared_ptr<BakedRegion> region = std::make_shared<BakedRegion>(world_generator_.GetSeed(), world_generator_.GetSettingsFingerprint(), region_x, region_z);
+	region->Read(BakedRegion::GetPath(baked_directory_, region_x, region_z));
+	if (baked_regions_.size() == BAKED_REGIONS)
+		baked_regions_.erase(baked_regions_.begin());
+	baked_regions_.push_back(region);
+	return region;
+}
+
+void ChunkManager::UnloadChunk(long long int chunk_x, long long int chunk_z)
+{
+	std::unique_ptr<Chunk> chunk = chunks_.Remove(chunk_x, chunk_z);
+	if (!chunk)
+		return;
+	if (chunk->Meshed())
+		chunk->Delete();
+	unused_chunks_.push_back(std::move(chunk));
+}
+
+Chunk& ChunkManager::AddChunk(long long int chunk_x, long long int chunk_z)
+{
+	std::unique_ptr<Chunk> chunk;
+	if (unused_chunks_.empty())
+		chunk = std::make_unique<Chunk>(glm::i64vec3(chunk_x, 0, chunk_z), *this);
+	else
+	{
+		chunk = std::move(unused_chunks_.back());
+		unused_chunks_.pop_back();
+		chunk->ReuseChunk(glm::i64vec3(chunk_x, 0, chunk_z));
+	}
+	Chunk& chunk_ref = *chunk;
+	chunks_.Insert(chunk_x, chunk_z, std::move(chunk));
+	return chunk_ref;
+}
+
+inline bool ChunkManager::InGenerationArea(long long int chunk_x, long long int chunk_z) const
+{
+	return chunk_x >= chunk_offset_.x - generation_distance_ && chunk_x <= chunk_offset_.x + generation_distance_ &&
+		chunk_z >= chunk_offset_.z - generation_distance_ && chunk_z <= chunk_offset_.z + generation_distance_;
+}
+
+// rebuilds all meshes with the new mode, slow (same as initial meshing), meant for comparing meshers at runtime
+void ChunkManager::SetMeshingMode(MeshingMode mode)
+{
+	if (mode == meshing_mode_)
+		return;
+	meshing_mode_ = mode;
+
+	auto start = high_resolution_clock::now();
+	for (int z = -render_distance_; z <= render_distance_; ++z)
+		for (int x = -render_distance_; x <= render_distance_; ++x)
+		{
+			Chunk* chunk = FindChunk(x + chunk_offset_.x, z + chunk_offset_.z);
+			if (chunk->Meshed())
+				chunk->Delete();
+		}
+
+#ifndef _DEBUG
+#ifdef VULKAN
+#pragma omp parallel for collapse(2)	// opengl and multithreading :)
+#endif
+#endif
+	for (int z = -render_distance_; z <= render_distance_; ++z)
+		for (int x = -render_distance_; x <= render_distance_; ++x)
+			FindChunk(x + chunk_offset_.x, z + chunk_offset_.z)->BuildMesh(GetLod(x + chunk_offset_.x, z + chunk_offset_.z));
+
+#ifdef VULKAN
+	renderer_.ForceRebuild();
+#endif
+	auto stop = high_resolution_clock::now();
+	std::cout << (mode == MeshingMode::Greedy ? "Greedy" : "Naive") << " meshing time: " << duration_cast<milliseconds>(stop - start).count() << std::endl;
+}
+
 void ChunkManager::SetBlock(long long int x, long long int y, long long int z, BlockId block)
 {
-	if (OutOfBounds(x, y, z))
+	const long long int x_chunk = (long long int)floor((double)x / (double)CHUNK_SIZE_X);
+	const long long int z_chunk = (long long int)floor((double)z / (double)CHUNK_SIZE_Z);
+	Chunk* chunk = FindChunk(x_chunk, z_chunk);
+	if (chunk == nullptr || y >= CHUNK_SIZE_Y || y < 0)
 	{
-		//TODO for constant world size we cannot set block out of bounds, 
-		//for infinite, we need to store in some list of not set blocks and set them in future once chunks are loaded
+		//TODO for unloaded chunks we need to store in some list of not set blocks and set them in future once chunks are loaded
 		assert(false);
 		return;
 	}
-	int x_chunk = floor((double)x / (double)CHUNK_SIZE_X) - chunk_offset_.x;
-	int z_chunk = floor((double)z / (double)CHUNK_SIZE_Z) - chunk_offset_.z;
 	int x_local = ((x % CHUNK_SIZE_X) + CHUNK_SIZE_X) % CHUNK_SIZE_X;
 	int z_local = ((z % CHUNK_SIZE_Z) + CHUNK_SIZE_Z) % CHUNK_SIZE_Z;
 
-	chunks_[GetChunkIndex(x_chunk, z_chunk)].SetBlock(x_local, y, z_local, block);
+	chunk->SetBlock(x_local, y, z_local, block);	// marks its own sections
+	QueueDirtyChunk(x_chunk, z_chunk);
+
+	// block on chunk border is visible from neighbour as well, and it changes ambient occlusion of neighbour blocks
+	// one layer up and down, block on chunk corner even of diagonal neighbour
+	const int x_begin = x_local == 0 ? -1 : 0;
+	const int x_end = x_local == CHUNK_SIZE_X - 1 ? 1 : 0;
+	const int z_begin = z_local == 0 ? -1 : 0;
+	const int z_end = z_local == CHUNK_SIZE_Z - 1 ? 1 : 0;
+	const int section_begin = std::max((int)y - 1, 0) / SECTION_SIZE;
+	const int section_end = std::min((int)y + 1, CHUNK_SIZE_Y - 1) / SECTION_SIZE;
+	for (int dz = z_begin; dz <= z_end; ++dz)
+		for (int dx = x_begin; dx <= x_end; ++dx)
+			for (int section_y = section_begin; section_y <= section_end && (dx != 0 || dz != 0); ++section_y)
+				MarkSectionDirty(x_chunk + dx, z_chunk + dz, section_y);
 }
 
-BlockId ChunkManager::GetBlock(long long int x, long long int y, long long int z) const
+bool ChunkManager::InEditArea(long long int chunk_x, long long int chunk_z) const
 {
-	if (OutOfBounds(x, y, z))
-		return	y >= CHUNK_SIZE_Y ? BlockId::Air : BlockId::Stone;
-	int x_chunk = floor((double)x / (double)CHUNK_SIZE_X) - chunk_offset_.x;
-	int z_chunk = floor((double)z / (double)CHUNK_SIZE_Z) - chunk_offset_.z;
-	int x_local = ((x % CHUNK_SIZE_X) + CHUNK_SIZE_X) % CHUNK_SIZE_X;
-	int z_local = ((z % CHUNK_SIZE_Z) + CHUNK_SIZE_Z) % CHUNK_SIZE_Z;
+	return std::max(std::abs(chunk_x - chunk_offset_.x), std::abs(chunk_z - chunk_offset_.z)) <= edit_cache_distance_;
+}
 
-	return chunks_[GetChunkIndex(x_chunk, z_chunk)].GetBlock(x_local, y, z_local);
+int ChunkManager::GetLod(long long int chunk_x, long long int chunk_z) const
+{
+	return GetLod(chunk_x, chunk_z, chunk_offset_);
 }
 
-inline int ChunkManager::GetChunkIndex(int x, int z) const
+inline int ChunkManager::GetLod(long long int chunk_x, long long int chunk_z, glm::i64vec3 center) const
 {
-	return (x + internal_array_offset_.x + generation_distance_ + chunks_dimension_length_) % chunks_dimension_length_ +
-		(z + internal_array_offset_.z + generation_distance_ + chunks_dimension_length_) % chunks_dimension_length_ * chunks_dimension_length_;
+	if (!LOD_MESHING)
+		return 1;
+	const long long int distance = std::max(std::abs(chunk_x - center.x), std::abs(chunk_z - center.z));
+	if (distance >= LOD_RING_8X)
+		return 8;
+	if (distance >= LOD_RING_4X)
+		return 4;
+	if (distance >= LOD_RING_2X)
+		return 2;
+	return 1;
 }
 
-Chunk& ChunkManager::GetChunk(long long int x, long long int z)
+void ChunkManager::MarkSectionDirty(long long int chunk_x, long long int chunk_z, int section_y)
 {
-	return chunks_[GetChunkIndex(x, z)];
+	Chunk* chunk = FindChunk(chunk_x, chunk_z);
+	if (chunk == nullptr)
+		return;
+	chunk->MarkSectionDirty(section_y);
+	QueueDirtyChunk(chunk_x, chunk_z);
 }
 
-inline bool ChunkManager::OutOfBounds(long long int x, long long int y, long long int z) const
+void ChunkManager::QueueDirtyChunk(long long int chunk_x, long long int chunk_z)
 {
-	/*	return  x >= CHUNK_SIZE_X * (1 + generation_distance_ + chunk_offset_.x) || x < CHUNK_SIZE_X * (-generation_distance_ + chunk_offset_.x) ||
-			y >= CHUNK_SIZE_Y || y < 0 ||
-			z >= CHUNK_SIZE_Z * (1 + generation_distance_ + chunk_offset_.z) || z < CHUNK_SIZE_Z * (-generation_distance_ + chunk_offset_.z);*/
-	if (x >= CHUNK_SIZE_X * (1 + generation_distance_ + chunk_offset_.x) || x < CHUNK_SIZE_X * (-generation_distance_ + chunk_offset_.x) ||
-		z >= CHUNK_SIZE_Z * (1 + generation_distance_ + chunk_offset_.z) || z < CHUNK_SIZE_Z * (-generation_distance_ + chunk_offset_.z))
-		assert(false);	//TODO remove later
-	return  y >= CHUNK_SIZE_Y || y < 0;
+	const ChunkHandle handle = FindChunkHandle(chunk_x, chunk_z);
+	Chunk* chunk = GetChunk(handle);
+	if (chunk == nullptr || !chunk->HasDirtySections())
+		return;
+	// there is only few edits per frame, linear search is fine
+	if (std::find(dirty_chunks_.begin(), dirty_chunks_.end(), handle) == dirty_chunks_.end())
+		dirty_chunks_.push_back(handle);
+}
+
+void ChunkManager::UpdateDirtyChunks()
+{
+	if (dirty_chunks_.empty())
+		return;
+
+	int updated = 0;
+	for (const ChunkHandle& handle : dirty_chunks_)
+	{
+		Chunk* chunk = GetChunk(handle);
+		if (chunk == nullptr || !chunk->HasDirtySections())
+			continue;
+		chunk->UpdateMesh();
+		++updated;
+	}
+	dirty_chunks_.clear();
+	if (updated == 0)
+		return;
+
+#ifdef VULKAN
+	renderer_.ForceUpdate();	// same chunks, only their BLAS are new
+#endif
+}
+
+BlockId ChunkManager::GetBlock(long long int x, long long int y, long long int z) const
+{
+	if (y >= CHUNK_SIZE_Y || y < 0)
+		return	y >= CHUNK_SIZE_Y ? BlockId::Air : BlockId::Stone;
+	const long long int x_chunk = (long long int)floor((double)x / (double)CHUNK_SIZE_X);
+	const long long int z_chunk = (long long int)floor((double)z / (double)CHUNK_SIZE_Z);
+	const Chunk* chunk = FindChunk(x_chunk, z_chunk);
+	if (chunk == nullptr)
+		return BlockId::Air;
+	int x_local = ((x % CHUNK_SIZE_X) + CHUNK_SIZE_X) % CHUNK_SIZE_X;
+	int z_local = ((z % CHUNK_SIZE_Z) + CHUNK_SIZE_Z) % CHUNK_SIZE_Z;
+
+	return chunk->GetBlock(x_local, y, z_local);
 }
 
 #ifdef VULKAN
 const std::vector<BottomLevelAccelerationStructure> ChunkManager::GetAllBLAS() const
 {
 	std::vector<BottomLevelAccelerationStructure> blases;
-	blases.reserve(chunks_dimension_length_ * chunks_dimension_length_);
-	for (const auto& chunk : chunks_)
-	{
+	blases.reserve(chunks_.Size());
+	chunks_.ForEach([&blases](const Chunk& chunk) {
 		if (chunk.Meshed())
 			blases.push_back(chunk.GetBLAS());
-	}
+	});
 	return blases;
 }
 #endif
 
 #ifdef OPENGL
-void ChunkManager::Draw() const
+void ChunkManager::Draw(Shader& shader) const
 {
-	for (int z = -generation_distance_; z <= generation_distance_; ++z)
-		for (int x = -generation_distance_; x <= generation_distance_; ++x)
-			if (chunks_[GetChunkIndex(x, z)].Meshed())
-				chunks_[GetChunkIndex(x, z)].Draw();
+	chunks_.ForEach([&shader](const Chunk& chunk) {
+		if (chunk.Meshed())
+			chunk.Draw(shader);
+	});
 }
 #endif
\ No newline at end of file
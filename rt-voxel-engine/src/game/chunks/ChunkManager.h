@@ -1,18 +1,27 @@
 #pragma once
 #include "Chunk.h"
 #include "WorldGenerator.h"
-#include "renderer-vulkan-rt\RendererRT.h"
+#include "MeshingMode.h"
+#include "GenerationStage.h"
+#include "ChunkRegistry.h"
+#include "BakedRegion.h"
+#ifdef VULKAN
+#include "renderer-vulkan-rt/RendererRT.h"
+#endif
 #include "game/blocks/BlockId.h"
 #include "game/blocks/BlockDatabase.h"
+#include <memory>
+#include <string>
 #include <vector>
 
 class Chunk;
 class RendererRT;
+class Shader;
 
 class ChunkManager
 {
 public:
-#ifdef OPENGL
+#if defined(OPENGL) || defined(HEADLESS)
 	ChunkManager(int render_distance, glm::vec3 player_position, int world_generator_seed);	//TODO what about y axis
 #endif
 #ifdef VULKAN
@@ -21,20 +30,47 @@ public:
 	~ChunkManager();
 	void GenerateChunks();
 	void UpdateCenter(glm::vec3 player_position);
+	void UpdateDirtyChunks();	// remeshes sections changed by SetBlock since last call, call once per frame
 
+	// chunk coordinates are global, chunks can be loaded anywhere, not only around the center (e.g. spawn area, teleport target)
+	Chunk& LoadChunk(long long int chunk_x, long long int chunk_z);	// generates chunk (and neighbours it needs) if it is not lit yet, does not mesh it
+	// brings chunks within radius (chebyshev, in chunks) around center to stage, missing chunks are added, chunks around them only as far
+	// as needed (stage N needs neighbours at N - 1, so there are GENERATION_MARGIN rings of partially generated chunks),
+	// every stage is one parallel pass over all chunks which need it
+	void GenerateArea(long long int center_x, long long int center_z, int radius, GenerationStage stage = GenerationStage::Lit);
+	inline size_t GetChunkCount() const { return chunks_.Size(); };
+	// chunks baked into this directory (ChunkBaker, seed of this world) are loaded by GenerateArea instead of generated, empty = none
+	void SetBakedWorld(const std::string& directory);
+	inline size_t GetLoadedBakedChunks() const { return loaded_baked_chunks_; };
+	void UnloadChunk(long long int chunk_x, long long int chunk_z);
+
+	int GetLod(long long int chunk_x, long long int chunk_z) const;	// by distance from center, LOD_RING_* in config.h
+	bool InEditArea(long long int chunk_x, long long int chunk_z) const;	// within edit cache distance of center
 	void SetBlock(long long int x, long long int y, long long int z, BlockId block);
 	BlockId GetBlock(long long int x, long long int y, long long int z) const;
-	inline int GetChunkIndex(int x, int z) const;
-	Chunk& GetChunk(long long int x, long long int z);	//TODO inline it later
-	inline bool OutOfBounds(long long int x, long long int y, long long int z) const;
+	// returns nullptr when chunk is not loaded
+	inline Chunk* FindChunk(long long int chunk_x, long long int chunk_z) const { return chunks_.Find(chunk_x, chunk_z); };
+	inline ChunkHandle FindChunkHandle(long long int chunk_x, long long int chunk_z) const { return chunks_.FindHandle(chunk_x, chunk_z); };
+	inline Chunk* GetChunk(ChunkHandle handle) const { return chunks_.Get(handle); };
 	inline const BlockDatabase& GetBlockDatabase() const { return block_database_; };
 	inline const WorldGenerator& GetWorldGenerator() const { return world_generator_; };
+	inline WorldGenerator& GetWorldGenerator() { return world_generator_; };	// changes apply only to chunks generated after them
+	inline MeshingMode GetMeshingMode() const { return meshing_mode_; };
+	void SetMeshingMode(MeshingMode mode);
+	// see MESHING_ARENA in config.h, without arena every Chunk::BuildMesh allocates its own (only for comparison)
+	inline bool UsesMeshingArena() const { return meshing_arena_; };
+	inline void SetMeshingArena(bool enabled) { meshing_arena_ = enabled; };
+	// see BAKED_AO in config.h, applies to chunks meshed after it
+	inline bool UsesBakedAo() const { return baked_ao_; };
+	inline void SetBakedAo(bool enabled) { baked_ao_ = enabled; };
+	// see EDIT_CACHE_DISTANCE in config.h, applies to chunks meshed after it, negative means no chunk keeps section cache until edited
+	inline void SetEditCacheDistance(int distance) { edit_cache_distance_ = distance; };
 #ifdef VULKAN
 	RendererRT& GetRenderer() const { return renderer_; };
 	const std::vector<BottomLevelAccelerationStructure> GetAllBLAS() const;
 #endif
 #ifdef OPENGL
-	void Draw() const;
+	void Draw(Shader& shader) const;
 #endif
 private:
 	BlockDatabase block_database_;
@@ -42,10 +78,25 @@ private:
 #ifdef VULKAN
 	RendererRT& renderer_;
 #endif
-	std::vector<Chunk> chunks_;
+	Chunk& AddChunk(long long int chunk_x, long long int chunk_z);	// not generated yet
+	void LoadBakedChunks(std::vector<Chunk*>& pending);	// of empty chunks, loaded ones are removed from pending
+	std::shared_ptr<const BakedRegion> FindBakedRegion(int region_x, int region_z);	// read from disk when it is not among recent ones
+	inline bool InGenerationArea(long long int chunk_x, long long int chunk_z) const;
+	inline int GetLod(long long int chunk_x, long long int chunk_z, glm::i64vec3 center) const;
+	void MarkSectionDirty(long long int chunk_x, long long int chunk_z, int section_y);
+	void QueueDirtyChunk(long long int chunk_x, long long int chunk_z);
+
+	ChunkRegistry chunks_;
+	std::vector<std::unique_ptr<Chunk>> unused_chunks_;	// unloaded chunks, reused by AddChunk (ReuseChunk) instead of allocating new ones
+	std::vector<ChunkHandle> dirty_chunks_;	// chunks with dirty sections, handle becomes stale if chunk is unloaded before update
+	MeshingMode meshing_mode_;
+	bool meshing_arena_;
+	bool baked_ao_;
+	int edit_cache_distance_;
 	int render_distance_;
 	int generation_distance_;
-	int chunks_dimension_length_;
-	glm::i64vec3 chunk_offset_;
-	glm::ivec3 internal_array_offset_;
+	glm::i64vec3 chunk_offset_;	// center of loaded area in chunks
+	std::string baked_directory_;
+	std::vector<std::shared_ptr<const BakedRegion>> baked_regions_;	// most recently used last, also regions without file (no chunks)
+	size_t loaded_baked_chunks_;
 };
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// bits 1 ... SECTION_SIZE, halo bits (0 and SECTION_SIZE + 1) belongs to neighbours
+	const uint64_t INNER_BITS = ((uint64_t(1) << SECTION_SIZE) - 1) << 1;
+
+	inline int CountTrailingZeros(uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+}
+
+ChunkMesher::ChunkMesher(const BlockDatabase& db, MeshingMode mode, bool ambient_occlusion, Scratch& scratch)
+	: db_(db), mode_(mode), ambient_occlusion_(ambient_occlusion), scratch_(scratch), ao_tables_(GetAoTables(db))
+{
+	for (int block = 0; block < BLOCK_COUNT; ++block)
+		opaque_[block] = !db_.GetBlockData(static_cast<BlockId>(block)).isTransparent();
+}
+
+const ChunkMesher::AoTables& ChunkMesher::GetAoTables(const BlockDatabase& db)
+{
+	static const AoTables tables(db);
+	return tables;
+}
+
+ChunkMesher::AoTables::AoTables(const BlockDatabase& db)
+{
+	const auto to_offset = [](const glm::ivec3& v) { return v.x * ChunkSnapshot::STRIDE_X + v.y * ChunkSnapshot::STRIDE_Y + v.z * ChunkSnapshot::STRIDE_Z; };
+
+	for (int face = 0; face < static_cast<int>(Face::NUM_FACES); ++face)
+	{
+		const auto& face_vert = db.GetFaceVertices(static_cast<Face>(face));
+		// axis along which all vertices are same (normal) sums to 0 or 4, both axes along face to 2
+		const glm::ivec3 vertex_sum = glm::ivec3(face_vert[0] + face_vert[1] + face_vert[2] + face_vert[3]);
+		glm::ivec3 normal(0);
+		int tangents[2];
+		int tangent_count = 0;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (vertex_sum[axis] == 2)
+				tangents[tangent_count++] = axis;
+			else
+				normal[axis] = vertex_sum[axis] == 4 ? 1 : -1;
+		}
+
+		// 3x3 blocks in front of the face without the middle one, bit (u + 1) + (v + 1) * 3 (middle bit skipped)
+		const auto ring_bit = [](int u, int v) { const int bit = (u + 1) + (v + 1) * 3; return bit > 4 ? bit - 1 : bit; };
+		for (int v = -1; v <= 1; ++v)
+			for (int u = -1; u <= 1; ++u)
+				if (u != 0 || v != 0)
+				{
+					glm::ivec3 block = normal;
+					block[tangents[0]] += u;
+					block[tangents[1]] += v;
+					ring[face][ring_bit(u, v)] = to_offset(block);
+				}
+
+		// corner of face (0 or 1 on both axes along face) points away from face center by -1 or 1 on those axes,
+		// its sides are ring blocks moved along one of them, corner block along both
+		for (int blocks = 0; blocks < 256; ++blocks)
+		{
+			uint8_t corners = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				const int u = int(face_vert[i][tangents[0]]) * 2 - 1;
+				const int v = int(face_vert[i][tangents[1]]) * 2 - 1;
+				const int side1 = (blocks >> ring_bit(u, 0)) & 1;
+				const int side2 = (blocks >> ring_bit(0, v)) & 1;
+				const int corner = (blocks >> ring_bit(u, v)) & 1;
+				corners |= (side1 && side2 ? 0 : 3 - side1 - side2 - corner) << (i * 2);
+			}
+			ao[face][blocks] = corners;
+		}
+
+		// face can be merged along axis when corners differing only in that axis have same occlusion
+		const int bit_axis = face == static_cast<int>(Face::LEFT_FACE) || face == static_cast<int>(Face::RIGHT_FACE) ? 2 : 0;
+		const int row_axis = face == static_cast<int>(Face::TOP_FACE) || face == static_cast<int>(Face::BOTTOM_FACE) ? 2 : 1;
+		for (int corners = 0; corners < 256; ++corners)
+		{
+			uint8_t directions = MERGE_ROW | MERGE_ROWS;
+			for (int i = 0; i < 4; ++i)
+				for (int j = 0; j < 4; ++j)
+				{
+					if (((corners >> (i * 2)) & 0x3) == ((corners >> (j * 2)) & 0x3))
+						continue;
+					if (face_vert[i][row_axis] == face_vert[j][row_axis])
+						directions &= ~MERGE_ROW;
+					if (face_vert[i][bit_axis] == face_vert[j][bit_axis])
+						directions &= ~MERGE_ROWS;
+				}
+			merge[face][corners] = directions;
+		}
+	}
+}
+
+void ChunkMesher::Build(const ChunkSnapshot& snapshot, LayeredVertices& vertices)
+{
+	for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+		BuildSection(snapshot, section_y, vertices);
+}
+
+void ChunkMesher::BuildSection(const ChunkSnapshot& snapshot, int section_y, LayeredVertices& vertices)
+{
+	SectionOccupancy& occupancy = scratch_.occupancy;
+
+	// air sections have nothing to mesh, solid ones surrounded by other solid ones neither
+	if (snapshot.GetSectionState(section_y) == SectionState::Empty || snapshot.IsSectionOccluded(section_y))
+		return;
+	// same for sections fully outside of layers which can have visible faces
+	if (section_y * SECTION_SIZE >= snapshot.GetMeshYEnd() || (section_y + 1) * SECTION_SIZE <= snapshot.GetMeshYBegin())
+		return;
+
+	BuildOccupancy(snapshot, section_y);
+	const glm::ivec3 section_offset(0, section_y * SECTION_SIZE, 0);
+	// LOD cells are bigger than the 1 block occlusion is computed from, far chunks do not need it anyway
+	const bool ambient_occlusion = ambient_occlusion_ && snapshot.GetLod() == 1;
+	const int y_begin = std::max(snapshot.GetMeshYBegin() - section_y * SECTION_SIZE, 0);	// same as in BuildOccupancy
+
+	for (int block = 1; block < BLOCK_COUNT; ++block)
+	{
+		if (!occupancy.present[block])
+			continue;
+		const Block& block_data = db_.GetBlockData(static_cast<BlockId>(block));
+		std::vector<uint32_t>& layer_vertices = vertices[static_cast<int>(block_data.getMeshLayer())];
+
+		BuildFacePlanes(block);
+		for (int face = 0; face < static_cast<int>(Face::NUM_FACES); ++face)
+		{
+			const int texture = face == static_cast<int>(Face::TOP_FACE) ? block_data.getTextureTop() :
+				face == static_cast<int>(Face::BOTTOM_FACE) ? block_data.getTextureBottom() : block_data.getTextureSides();
+
+			for (uint32_t slices = scratch_.slices[face]; slices; slices &= slices - 1)
+			{
+				const int slice = CountTrailingZeros(slices);
+				uint16_t* rows = scratch_.planes[face][slice];
+				const auto get_position = [face, slice](int row, int bit)
+				{
+					switch (static_cast<Face>(face))
+					{
+					case Face::TOP_FACE:
+					case Face::BOTTOM_FACE:
+						return glm::ivec3(bit, slice, row);
+					case Face::FRONT_FACE:
+					case Face::BACK_FACE:
+						return glm::ivec3(bit, row, slice);
+					default:
+						return glm::ivec3(slice, row, bit);
+					}
+				};
+
+				// occlusion of every visible face in slice first, greedy has to know it before merging
+				if (ambient_occlusion)
+				{
+					const int bit_stride = face == static_cast<int>(Face::LEFT_FACE) || face == static_cast<int>(Face::RIGHT_FACE) ?
+						ChunkSnapshot::STRIDE_Z : ChunkSnapshot::STRIDE_X;
+					for (int row = 0; row < SECTION_SIZE; ++row)
+					{
+						const glm::ivec3 row_position = section_offset + get_position(row, 0);
+						const int row_index = snapshot.GetIndex(row_position.x, row_position.y, row_position.z);
+						// most faces have nothing around them, ring is sampled only for ones which have
+						uint32_t sampled = rows[row];
+						uint16_t occluded;
+						if (FindOccludedFaces(face, slice, row, y_begin, occluded))
+						{
+							for (uint32_t bits = rows[row] & ~occluded; bits; bits &= bits - 1)
+								scratch_.ao[row][CountTrailingZeros(bits)] = ao_tables_.ao[face][0];
+							sampled &= occluded;
+						}
+						for (uint32_t bits = sampled; bits; bits &= bits - 1)
+						{
+							const int bit = CountTrailingZeros(bits);
+							scratch_.ao[row][bit] = ComputeAo(snapshot, face, row_index + bit * bit_stride);
+						}
+					}
+				}
+
+				for (int row = 0; row < SECTION_SIZE; ++row)
+				{
+					while (rows[row])
+					{
+						const uint32_t bits = rows[row];
+						const int bit = CountTrailingZeros(bits);
+						const uint8_t ao = ambient_occlusion ? scratch_.ao[row][bit] : 0xff;
+						int width = 1;
+						int height = 1;
+						if (mode_ == MeshingMode::Greedy)
+						{
+							// widest run starting at bit, then grow it over following rows as long as they contain whole run,
+							// faces must have same occlusion and it must not change in merged direction, gradient would be stretched over whole quad
+							const uint8_t merge = ao_tables_.merge[face][ao];
+							width = merge & MERGE_ROW ? CountTrailingZeros(~(bits >> bit)) : 1;
+							if (ambient_occlusion)
+								for (int i = 1; i < width; ++i)
+									if (scratch_.ao[row][bit + i] != ao)
+										width = i;
+							const uint16_t run = static_cast<uint16_t>(((1u << width) - 1) << bit);
+							const auto same_ao = [&](int next_row)
+							{
+								if (!ambient_occlusion)
+									return true;
+								for (int i = bit; i < bit + width; ++i)
+									if (scratch_.ao[next_row][i] != ao)
+										return false;
+								return true;
+							};
+							while (merge & MERGE_ROWS && row + height < SECTION_SIZE && (rows[row + height] & run) == run && same_ao(row + height))
+								rows[row + height++] &= ~run;
+						}
+						rows[row] &= ~static_cast<uint16_t>(((1u << width) - 1) << bit);
+
+						glm::ivec3 size;
+						switch (static_cast<Face>(face))
+						{
+						case Face::TOP_FACE:
+						case Face::BOTTOM_FACE:
+							size = glm::ivec3(width, 1, height);
+							break;
+						case Face::FRONT_FACE:
+						case Face::BACK_FACE:
+							size = glm::ivec3(width, height, 1);
+							break;
+						default:
+							size = glm::ivec3(1, height, width);
+							break;
+						}
+						AddFace(layer_vertices, static_cast<Face>(face), texture, section_offset + get_position(row, bit), size, ao);
+					}
+				}
+			}
+		}
+	}
+}
+
+// scatter visible bits from occupancy columns/rows into per face planes
+void ChunkMesher::BuildFacePlanes(int block)
+{
+	const SectionOccupancy& occupancy = scratch_.occupancy;
+	std::memset(scratch_.planes, 0, sizeof(scratch_.planes));
+	std::memset(scratch_.slices, 0, sizeof(scratch_.slices));
+
+	const auto scatter = [this](Face face, uint64_t visible, int row, int bit)
+	{
+		visible &= INNER_BITS;
+		scratch_.slices[static_cast<int>(face)] |= static_cast<uint16_t>(visible >> 1);
+		for (; visible; visible &= visible - 1)
+			scratch_.planes[static_cast<int>(face)][CountTrailingZeros(visible) - 1][row] |= uint16_t(1) << bit;
+	};
+
+	for (int a = 0; a < SECTION_SIZE; ++a)
+		for (int b = 0; b < SECTION_SIZE; ++b)
+		{
+			// columns along y, (a, b) = (x, z)
+			uint64_t mask = occupancy.blocks[block][AXIS_Y][a][b];
+			uint64_t occluders = mask | occupancy.opaque[AXIS_Y][a][b];
+			scatter(Face::BOTTOM_FACE, mask & ~(occluders << 1), b, a);
+			scatter(Face::TOP_FACE, mask & ~(occluders >> 1), b, a);
+
+			// rows along z, (a, b) = (y, x)
+			mask = occupancy.blocks[block][AXIS_Z][a][b];
+			occluders = mask | occupancy.opaque[AXIS_Z][a][b];
+			scatter(Face::BACK_FACE, mask & ~(occluders << 1), a, b);
+			scatter(Face::FRONT_FACE, mask & ~(occluders >> 1), a, b);
+
+			// rows along x, (a, b) = (y, z)
+			mask = occupancy.blocks[block][AXIS_X][a][b];
+			occluders = mask | occupancy.opaque[AXIS_X][a][b];
+			scatter(Face::LEFT_FACE, mask & ~(occluders << 1), a, b);
+			scatter(Face::RIGHT_FACE, mask & ~(occluders >> 1), a, b);
+		}
+}
+
+void ChunkMesher::BuildOccupancy(const ChunkSnapshot& snapshot, int section_y)
+{
+	SectionOccupancy& occupancy = scratch_.occupancy;
+	std::memset(&occupancy, 0, sizeof(SectionOccupancy));
+
+	const int y_base = section_y * SECTION_SIZE;
+	const auto mark = [&](BlockId block, Axis axis, int a, int b, int bit)
+	{
+		occupancy.blocks[static_cast<int>(block)][axis][a][b] |= uint64_t(1) << bit;
+	};
+
+	// layers outside of snapshot mesh range are skipped, ones below it are non transparent,
+	// so they are only marked as occluders (bottom faces of first meshed layer are hidden by them)
+	const int y_begin = std::max(snapshot.GetMeshYBegin() - y_base, 0);
+	const int y_end = std::min(snapshot.GetMeshYEnd() - y_base, SECTION_SIZE);
+	if (y_begin > 0)
+		for (int x = 0; x < SECTION_SIZE; ++x)
+			for (int z = 0; z < SECTION_SIZE; ++z)
+				occupancy.opaque[AXIS_Y][x][z] |= ((uint64_t(1) << y_begin) - 1) << 1;
+
+	for (int y = y_begin; y < y_end; ++y)
+		for (int z = 0; z < SECTION_SIZE; ++z)
+			for (int x = 0; x < SECTION_SIZE; ++x)
+			{
+				const BlockId block = snapshot.GetBlock(x, y_base + y, z);
+				if (block == BlockId::Air)
+					continue;
+				occupancy.present[static_cast<int>(block)] = true;
+				mark(block, AXIS_Y, x, z, y + 1);
+				mark(block, AXIS_X, y, z, x + 1);
+				mark(block, AXIS_Z, y, x, z + 1);
+			}
+
+	// halo, only needed as occluders so it does not mark block as present
+	for (int a = 0; a < SECTION_SIZE; ++a)
+		for (int b = 0; b < SECTION_SIZE; ++b)
+		{
+			mark(snapshot.GetBlock(a, y_base - 1, b), AXIS_Y, a, b, 0);
+			mark(snapshot.GetBlock(a, y_base + SECTION_SIZE, b), AXIS_Y, a, b, SECTION_SIZE + 1);
+			mark(snapshot.GetBlock(-1, y_base + a, b), AXIS_X, a, b, 0);
+			mark(snapshot.GetBlock(SECTION_SIZE, y_base + a, b), AXIS_X, a, b, SECTION_SIZE + 1);
+			mark(snapshot.GetBlock(b, y_base + a, -1), AXIS_Z, a, b, 0);
+			mark(snapshot.GetBlock(b, y_base + a, SECTION_SIZE), AXIS_Z, a, b, SECTION_SIZE + 1);
+		}
+
+	for (int block = 1; block < BLOCK_COUNT; ++block)
+	{
+		if (db_.GetBlockData(static_cast<BlockId>(block)).isTransparent())
+			continue;
+		for (int axis = 0; axis < AXIS_COUNT; ++axis)
+			for (int a = 0; a < SECTION_SIZE; ++a)
+				for (int b = 0; b < SECTION_SIZE; ++b)
+					occupancy.opaque[axis][a][b] |= occupancy.blocks[block][axis][a][b];
+	}
+}
+
+// faces of row (bit per face) which have any non transparent block among 3x3 blocks in front of them, taken from opaque masks
+// of rows of the layer in front (bits along row include halo), false when some of those rows are not in masks: outside of section
+// or below first meshed layer (those are marked only in AXIS_Y masks, see BuildOccupancy)
+bool ChunkMesher::FindOccludedFaces(int face, int slice, int row, int y_begin, uint16_t& occluded) const
+{
+	const SectionOccupancy& occupancy = scratch_.occupancy;
+	const Face face_id = static_cast<Face>(face);
+	const int front = face_id == Face::TOP_FACE || face_id == Face::FRONT_FACE || face_id == Face::RIGHT_FACE ? slice + 1 : slice - 1;
+	// TOP / BOTTOM: front is y, rows are z; others: rows are y, front is z (FRONT / BACK) or x (LEFT / RIGHT)
+	const bool horizontal = face_id == Face::TOP_FACE || face_id == Face::BOTTOM_FACE;
+	const int front_begin = horizontal ? y_begin : 0;
+	const int row_begin = horizontal ? 0 : y_begin;
+	if (front < front_begin || front >= SECTION_SIZE || row - 1 < row_begin || row + 1 >= SECTION_SIZE)
+		return false;
+
+	uint64_t around = 0;
+	for (int r = row - 1; r <= row + 1; ++r)
+	{
+		if (horizontal)
+			around |= occupancy.opaque[AXIS_X][front][r];
+		else if (face_id == Face::FRONT_FACE || face_id == Face::BACK_FACE)
+			around |= occupancy.opaque[AXIS_X][r][front];
+		else
+			around |= occupancy.opaque[AXIS_Z][r][front];
+	}
+	around |= (around << 1) | (around >> 1);
+	occluded = static_cast<uint16_t>((around & INNER_BITS) >> 1);
+	return true;
+}
+
+// classic 3 neighbour voxel AO, for each corner of face of block at snapshot index counts non transparent blocks
+// in front of the face touching the corner (both sides -> fully occluded regardless of corner block), those are looked up
+// from which of 8 blocks around the one in front of face are non transparent
+// returns 2 bits per corner in face vertex order, 3 means not occluded
+uint8_t ChunkMesher::ComputeAo(const ChunkSnapshot& snapshot, int face, int index) const
+{
+	const int* ring = ao_tables_.ring[face];
+	int blocks = 0;
+	for (int i = 0; i < 8; ++i)
+		blocks |= opaque_[static_cast<int>(snapshot.GetBlock(index + ring[i]))] << i;
+	return ao_tables_.ao[face][blocks];
+}
+
+void ChunkMesher::AddFace(std::vector<uint32_t>& vertices, Face face, int texture, const glm::ivec3& position, const glm::ivec3& size, uint8_t ao)
+{
+	const auto& face_vert = db_.GetFaceVertices(face);
+	const auto corner_ao = [ao](int i) { return (ao >> (i * 2)) & 0x3; };
+
+	// quad is split along 0 - 2 diagonal (see BuildQuadIndices), when other diagonal is brighter vertices are rotated by one
+	// so split goes along it, otherwise occlusion of one corner would spread over both triangles
+	const int first = corner_ao(0) + corner_ao(2) < corner_ao(1) + corner_ao(3) ? 1 : 0;
+	for (int j = 0; j < 4; ++j)
+	{
+		const int i = (first + j) % 4;
+		const glm::ivec3 vertex = position + glm::ivec3(face_vert[i]) * size;
+		vertices.emplace_back(ChunkVertex::Pack(vertex.x, vertex.y, vertex.z, static_cast<int>(face), texture, corner_ao(i)));
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ChunkSnapshot.h"
+#include "MeshingMode.h"
+#include "ChunkVertex.h"
+#include "MeshLayer.h"
+#include "game/blocks/BlockDatabase.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// "Binary meshing": for each section every block id present gets occupancy bit masks in three orientations
+// (columns along y, rows along x and along z), with 1 block halo around the section, so bit i means coordinate i - 1.
+// Visible faces of whole column/row are then found with one shift and and-not, instead of 6 IsVisible calls per block.
+// Opaque mask is union of all non transparent blocks. Transparent block is hidden only by opaque neighbour
+// or by the same block (water next to water), that's why every block keeps its own masks.
+// Visible faces are then scattered into 16x16 planes per face direction and emitted either one quad per face (Naive)
+// or merged into rectangles of same block (Greedy). Vertices are chunk local and packed, see ChunkVertex.h,
+// every block goes into vertices of its MeshLayer.
+// Every face gets classic voxel ambient occlusion per corner (2 sides + corner block next to the face, see ComputeAo),
+// greedy merges only faces with the same occlusion and only along axis occlusion does not change on (so gradient is not stretched),
+// quads are split along the diagonal which keeps occlusion symmetric.
+class ChunkMesher
+{
+private:
+	enum Axis { AXIS_Y = 0, AXIS_X, AXIS_Z, AXIS_COUNT };
+	static const int BLOCK_COUNT = static_cast<int>(BlockId::NUM_TYPES);
+	// directions in face plane (see Scratch::planes) in which faces with given occlusion can be merged
+	static const uint8_t MERGE_ROW = 1;		// along row (width)
+	static const uint8_t MERGE_ROWS = 2;	// over following rows (height)
+
+	struct SectionOccupancy
+	{
+		// [axis][a][b] where (a, b) is (x, z) for AXIS_Y, (y, z) for AXIS_X and (y, x) for AXIS_Z
+		uint64_t opaque[AXIS_COUNT][SECTION_SIZE][SECTION_SIZE];
+		uint64_t blocks[BLOCK_COUNT][AXIS_COUNT][SECTION_SIZE][SECTION_SIZE];
+		bool present[BLOCK_COUNT];
+	};
+	// depends only on face geometry, built once and shared by all meshers
+	struct AoTables
+	{
+		AoTables(const BlockDatabase& db);
+		// snapshot index offsets (from block) of 8 blocks around the one in front of face
+		int ring[static_cast<int>(Face::NUM_FACES)][8];
+		// occlusion of face corners for every combination of non transparent ring blocks
+		uint8_t ao[static_cast<int>(Face::NUM_FACES)][256];
+		// MERGE_ROW | MERGE_ROWS for every face and occlusion
+		uint8_t merge[static_cast<int>(Face::NUM_FACES)][256];
+	};
+public:
+	// working memory of Build (~60 KiB), not owned by mesher so it can be reused between chunks, see MeshingArena
+	struct Scratch
+	{
+		SectionOccupancy occupancy;
+		// visible faces of single block id in current section, [face][slice][row], one bit per cell in row
+		// TOP/BOTTOM: slice is y, row z, bit x; FRONT/BACK: slice z, row y, bit x; LEFT/RIGHT: slice x, row y, bit z
+		uint16_t planes[static_cast<int>(Face::NUM_FACES)][SECTION_SIZE][SECTION_SIZE];
+		// bit per slice which has any visible face
+		uint16_t slices[static_cast<int>(Face::NUM_FACES)];
+		// occlusion of visible faces in current plane slice, [row][bit], 2 bits per corner (in face vertex order)
+		uint8_t ao[SECTION_SIZE][SECTION_SIZE];
+	};
+
+	ChunkMesher(const BlockDatabase& db, MeshingMode mode, bool ambient_occlusion, Scratch& scratch);	// occlusion only at LOD 1
+	void Build(const ChunkSnapshot& snapshot, LayeredVertices& vertices);
+	// only one section, its faces depend only on the section and 1 block around it, so it can be rebuilt alone after edit
+	void BuildSection(const ChunkSnapshot& snapshot, int section_y, LayeredVertices& vertices);
+private:
+	static const AoTables& GetAoTables(const BlockDatabase& db);
+	void BuildOccupancy(const ChunkSnapshot& snapshot, int section_y);
+	void BuildFacePlanes(int block);
+	bool FindOccludedFaces(int face, int slice, int row, int y_begin, uint16_t& occluded) const;
+	uint8_t ComputeAo(const ChunkSnapshot& snapshot, int face, int index) const;
+	void AddFace(std::vector<uint32_t>& vertices, Face face, int texture, const glm::ivec3& position, const glm::ivec3& size, uint8_t ao);
+
+	const BlockDatabase& db_;
+	MeshingMode mode_;
+	bool ambient_occlusion_;
+	Scratch& scratch_;
+	const AoTables& ao_tables_;
+	bool opaque_[BLOCK_COUNT];
+};
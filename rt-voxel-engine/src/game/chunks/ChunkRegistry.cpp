@@ -0,0 +1,118 @@
+#include "ChunkRegistry.h"
+#include "Chunk.h"
+#include <cassert>
+
+ChunkRegistry::ChunkRegistry()
+	: mask_(0), count_(0)
+{
+	Rehash(64);
+}
+
+ChunkRegistry::~ChunkRegistry()
+{
+}
+
+ChunkHandle ChunkRegistry::Insert(long long int chunk_x, long long int chunk_z, std::unique_ptr<Chunk> chunk)
+{
+	const uint64_t key = PackKey(chunk_x, chunk_z);
+	assert(FindEntry(key) == NOT_FOUND);
+
+	if ((count_ + 1) * 2 > entries_.size())
+		Rehash(entries_.size() * 2);
+
+	uint32_t slot;
+	if (!free_slots_.empty())
+	{
+		slot = free_slots_.back();
+		free_slots_.pop_back();
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(slots_.size());
+		slots_.emplace_back();
+	}
+	slots_[slot].chunk = std::move(chunk);
+
+	size_t index = Hash(key) & mask_;
+	while (entries_[index].slot != EMPTY_ENTRY)
+		index = (index + 1) & mask_;
+	entries_[index] = { key, slot };
+	++count_;
+
+	return { slot, slots_[slot].generation };
+}
+
+std::unique_ptr<Chunk> ChunkRegistry::Remove(long long int chunk_x, long long int chunk_z)
+{
+	size_t index = FindEntry(PackKey(chunk_x, chunk_z));
+	if (index == NOT_FOUND)
+		return nullptr;
+
+	Slot& slot = slots_[entries_[index].slot];
+	std::unique_ptr<Chunk> chunk = std::move(slot.chunk);
+	++slot.generation;
+	free_slots_.push_back(entries_[index].slot);
+	--count_;
+
+	// backward shift: move following entries of the probe sequence into the hole, unless they would end up before their home position
+	size_t hole = index;
+	for (size_t next = (hole + 1) & mask_; entries_[next].slot != EMPTY_ENTRY; next = (next + 1) & mask_)
+	{
+		const size_t home = Hash(entries_[next].key) & mask_;
+		if (((next - home) & mask_) >= ((next - hole) & mask_))
+		{
+			entries_[hole] = entries_[next];
+			hole = next;
+		}
+	}
+	entries_[hole].slot = EMPTY_ENTRY;
+
+	return chunk;
+}
+
+Chunk* ChunkRegistry::Find(long long int chunk_x, long long int chunk_z) const
+{
+	const size_t index = FindEntry(PackKey(chunk_x, chunk_z));
+	return index == NOT_FOUND ? nullptr : slots_[entries_[index].slot].chunk.get();
+}
+
+ChunkHandle ChunkRegistry::FindHandle(long long int chunk_x, long long int chunk_z) const
+{
+	const size_t index = FindEntry(PackKey(chunk_x, chunk_z));
+	if (index == NOT_FOUND)
+		return ChunkHandle();
+	const uint32_t slot = entries_[index].slot;
+	return { slot, slots_[slot].generation };
+}
+
+Chunk* ChunkRegistry::Get(ChunkHandle handle) const
+{
+	if (handle.slot >= slots_.size() || slots_[handle.slot].generation != handle.generation)
+		return nullptr;
+	return slots_[handle.slot].chunk.get();
+}
+
+size_t ChunkRegistry::FindEntry(uint64_t key) const
+{
+	for (size_t index = Hash(key) & mask_; entries_[index].slot != EMPTY_ENTRY; index = (index + 1) & mask_)
+		if (entries_[index].key == key)
+			return index;
+	return NOT_FOUND;
+}
+
+void ChunkRegistry::Rehash(size_t capacity)
+{
+	std::vector<Entry> old_entries = std::move(entries_);
+	entries_.assign(capacity, { 0, EMPTY_ENTRY });
+	mask_ = capacity - 1;
+
+	for (const Entry& entry : old_entries)
+	{
+		if (entry.slot == EMPTY_ENTRY)
+			continue;
+		size_t index = Hash(entry.key) & mask_;
+		while (entries_[index].slot != EMPTY_ENTRY)
+			index = (index + 1) & mask_;
+		entries_[index] = entry;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Chunk;
+
+// Stable reference to loaded chunk. Once chunk is unloaded handle becomes stale (ChunkRegistry::Get returns nullptr),
+// even when its slot is later reused by another chunk.
+struct ChunkHandle
+{
+	uint32_t slot = UINT32_MAX;
+	uint32_t generation = 0;
+
+	inline bool operator==(const ChunkHandle& other) const { return slot == other.slot && generation == other.generation; }
+};
+
+// Loaded chunks keyed by chunk coordinates packed into 64 bits (x in high half, z in low half).
+// Lookup goes through open addressing hash table (linear probing, backward shift deletion so there are no tombstones),
+// which is kept at most half full. Table only maps key -> slot, chunks themselves are allocated separately and owned by slots_,
+// so chunk addresses and handles stay valid while table grows, no matter in which order chunks are loaded and unloaded.
+class ChunkRegistry
+{
+public:
+	ChunkRegistry();
+	~ChunkRegistry();
+
+	static inline uint64_t PackKey(long long int chunk_x, long long int chunk_z)
+	{
+		return (uint64_t(uint32_t(chunk_x)) << 32) | uint32_t(chunk_z);
+	}
+
+	// chunk must not be loaded yet
+	ChunkHandle Insert(long long int chunk_x, long long int chunk_z, std::unique_ptr<Chunk> chunk);
+	// returns unloaded chunk (nullptr if it was not loaded), so caller can reuse it
+	std::unique_ptr<Chunk> Remove(long long int chunk_x, long long int chunk_z);
+	Chunk* Find(long long int chunk_x, long long int chunk_z) const;
+	ChunkHandle FindHandle(long long int chunk_x, long long int chunk_z) const;
+	Chunk* Get(ChunkHandle handle) const;
+	inline size_t Size() const { return count_; }
+
+	// order is unspecified, registry must not be modified during iteration
+	template<typename Function>
+	void ForEach(Function&& function) const
+	{
+		for (const Slot& slot : slots_)
+			if (slot.chunk)
+				function(*slot.chunk);
+	}
+private:
+	struct Slot
+	{
+		std::unique_ptr<Chunk> chunk;
+		uint32_t generation = 0;
+	};
+	struct Entry
+	{
+		uint64_t key;
+		uint32_t slot;	// EMPTY_ENTRY when entry is free
+	};
+	static const uint32_t EMPTY_ENTRY = UINT32_MAX;
+	static const size_t NOT_FOUND = SIZE_MAX;
+
+	static inline uint64_t Hash(uint64_t key)
+	{
+		// splitmix64 finalizer, neighbouring chunks end up far apart
+		key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+		key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+		return key ^ (key >> 31);
+	}
+	// index into entries_, or NOT_FOUND
+	size_t FindEntry(uint64_t key) const;
+	void Rehash(size_t capacity);
+
+	std::vector<Entry> entries_;
+	size_t mask_;
+	size_t count_;
+	std::vector<Slot> slots_;
+	std::vector<uint32_t> free_slots_;
+};
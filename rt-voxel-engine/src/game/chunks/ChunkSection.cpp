@@ -0,0 +1,51 @@
+#include "ChunkSection.h"
+#include <array>
+
+ChunkSection::ChunkSection()
+	: blocks_(SECTION_VOLUME), non_air_count_(0), opaque_count_(0)
+{
+}
+
+void ChunkSection::SetBlock(int index, BlockId block, const BlockDatabase& db)
+{
+	const BlockId old_block = GetBlock(index);
+	if (old_block == block)
+		return;
+
+	non_air_count_ += (block != BlockId::Air) - (old_block != BlockId::Air);
+	opaque_count_ += !db.GetBlockData(block).isTransparent() - !db.GetBlockData(old_block).isTransparent();
+	blocks_.Set(index, block);
+}
+
+void ChunkSection::Fill(BlockId block, const BlockDatabase& db)
+{
+	blocks_.Fill(block);
+	non_air_count_ = block != BlockId::Air ? SECTION_VOLUME : 0;
+	opaque_count_ = !db.GetBlockData(block).isTransparent() ? SECTION_VOLUME : 0;
+}
+
+void ChunkSection::Assign(const BlockId* blocks, const BlockDatabase& db)
+{
+	std::array<int, static_cast<size_t>(BlockId::NUM_TYPES)> block_count{};
+	for (int i = 0; i < SECTION_VOLUME; ++i)
+		++block_count[static_cast<size_t>(blocks[i])];
+
+	non_air_count_ = SECTION_VOLUME - block_count[static_cast<size_t>(BlockId::Air)];
+	opaque_count_ = 0;
+	for (size_t block = 0; block < block_count.size(); ++block)
+		if (!db.GetBlockData(static_cast<BlockId>(block)).isTransparent())
+			opaque_count_ += block_count[block];
+	blocks_.Assign(blocks);
+}
+
+void ChunkSection::AssignRuns(const BlockRun* runs, int count, const BlockDatabase& db)
+{
+	non_air_count_ = 0;
+	opaque_count_ = 0;
+	for (int run = 0; run < count; ++run)
+	{
+		non_air_count_ += runs[run].block != BlockId::Air ? runs[run].length : 0;
+		opaque_count_ += !db.GetBlockData(runs[run].block).isTransparent() ? runs[run].length : 0;
+	}
+	blocks_.AssignRuns(runs, count);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BlockStorage.h"
+#include "game/blocks/BlockDatabase.h"
+
+const int SECTION_SIZE = 16;
+const int SECTION_VOLUME = SECTION_SIZE * SECTION_SIZE * SECTION_SIZE;
+
+enum class SectionState : unsigned char
+{
+	Empty = 0,	// only air
+	Solid,		// only non transparent blocks, so nothing inside can be visible
+	Mixed
+};
+
+// 16^3 vertical slice of chunk, it tracks how many air and non transparent blocks it holds,
+// so generation and meshing can skip uniform sections without looking at single block
+class ChunkSection
+{
+public:
+	ChunkSection();
+
+	inline BlockId GetBlock(int index) const { return non_air_count_ == 0 ? BlockId::Air : blocks_.Get(index); }
+	void SetBlock(int index, BlockId block, const BlockDatabase& db);
+	void Fill(BlockId block, const BlockDatabase& db);
+	void Assign(const BlockId* blocks, const BlockDatabase& db);	// all SECTION_VOLUME blocks, same layout as indices of SetBlock
+	void AssignRuns(const BlockRun* runs, int count, const BlockDatabase& db);	// same, as runs, blocks are counted per run
+	inline SectionState GetState() const
+	{
+		if (non_air_count_ == 0)
+			return SectionState::Empty;
+		if (opaque_count_ == SECTION_VOLUME)
+			return SectionState::Solid;
+		return SectionState::Mixed;
+	}
+	inline size_t MemoryUsage() const { return sizeof(*this) - sizeof(blocks_) + blocks_.MemoryUsage(); }
+private:
+	BlockStorage blocks_;
+	int non_air_count_;
+	int opaque_count_;
+};
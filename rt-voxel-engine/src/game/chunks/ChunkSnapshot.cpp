@@ -0,0 +1,202 @@
+#include "ChunkSnapshot.h"
+#include "ChunkManager.h"
+#include <algorithm>
+
+ChunkSnapshot::ChunkSnapshot()
+	: blocks_(SIZE_X * SIZE_Y * SIZE_Z, BlockId::Air)
+{
+	section_states_.fill(SectionState::Empty);
+	section_occluded_.fill(false);
+	mesh_y_begin_ = 0;
+	mesh_y_end_ = 0;
+	lod_ = 1;
+}
+
+void ChunkSnapshot::Capture(const Chunk& chunk, const ChunkManager& chunk_manager, uint16_t sections, int lod)
+{
+	const glm::i64vec3 position = chunk.GetGlobalPosition();
+	const Chunk* left = chunk_manager.FindChunk(position.x - 1, position.z);
+	const Chunk* right = chunk_manager.FindChunk(position.x + 1, position.z);
+	const Chunk* back = chunk_manager.FindChunk(position.x, position.z - 1);
+	const Chunk* front = chunk_manager.FindChunk(position.x, position.z + 1);
+	// diagonal ones only for corner columns, ambient occlusion of faces on chunk corners needs them
+	const Chunk* back_left = chunk_manager.FindChunk(position.x - 1, position.z - 1);
+	const Chunk* back_right = chunk_manager.FindChunk(position.x + 1, position.z - 1);
+	const Chunk* front_left = chunk_manager.FindChunk(position.x - 1, position.z + 1);
+	const Chunk* front_right = chunk_manager.FindChunk(position.x + 1, position.z + 1);
+	lod_ = lod;
+
+	// block below solid top of chunk and all of its neighbours cannot have visible face, block above max y is air
+	int solid_top = chunk.GetHeightSummary().solid_top;
+	for (const Chunk* neighbour : { left, right, back, front })
+		solid_top = std::min(solid_top, neighbour ? neighbour->GetHeightSummary().solid_top : -1);
+	mesh_y_begin_ = std::max(solid_top, 0);
+	mesh_y_end_ = chunk.GetHeightSummary().max_y + 1;
+	// whole LOD cells
+	mesh_y_begin_ = mesh_y_begin_ / lod * lod;
+	mesh_y_end_ = std::min((mesh_y_end_ + lod - 1) / lod * lod, CHUNK_SIZE_Y);
+	const int capture_begin = std::max(mesh_y_begin_ - 1, 0);
+	const int capture_end = std::min(mesh_y_end_ + 1, CHUNK_SIZE_Y);
+	const auto in_sections = [sections](int y) { return (sections >> (y / SECTION_SIZE)) & 1; };
+	// layer of requested section or layer right next to it
+	const auto captured = [&in_sections](int y)
+	{
+		return in_sections(y) || (y % SECTION_SIZE == SECTION_SIZE - 1 && in_sections(y + 1)) || (y % SECTION_SIZE == 0 && y > 0 && in_sections(y - 1));
+	};
+
+	// chunk itself, row by row so empty sections are just memset
+	for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+	{
+		const ChunkSection& section = chunk.GetSection(section_y);
+		section_states_[section_y] = section.GetState();
+
+		const int y_begin = std::max(section_y * SECTION_SIZE, capture_begin);
+		const int y_end = std::min((section_y + 1) * SECTION_SIZE, capture_end);
+		for (int y = y_begin; y < y_end; ++y)
+		{
+			if (!captured(y))
+				continue;
+			for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+			{
+				BlockId* row = &blocks_[GetIndex(0, y, z)];
+				if (section_states_[section_y] == SectionState::Empty)
+				{
+					std::fill(row, row + CHUNK_SIZE_X, BlockId::Air);
+					continue;
+				}
+				const int section_index = z * CHUNK_SIZE_X + (y % SECTION_SIZE) * (CHUNK_SIZE_X * CHUNK_SIZE_Z);
+				for (int x = 0; x < CHUNK_SIZE_X; ++x)
+					row[x] = section.GetBlock(section_index + x);
+			}
+		}
+	}
+
+	// below the world there is only stone and above only air (same as ChunkManager::GetBlock)
+	std::fill(blocks_.begin(), blocks_.begin() + STRIDE_Y, BlockId::Stone);
+	std::fill(blocks_.end() - STRIDE_Y, blocks_.end(), BlockId::Air);
+
+	if (lod > 1)
+	{
+		// skirts (air border, so chunk is closed by walls) only towards chunks of other LOD or not loaded ones,
+		// border from chunk of the same LOD is downsampled below, faces between such chunks are culled as in full detail
+		const auto same_lod = [&chunk_manager, lod](const Chunk* neighbour)
+		{
+			return neighbour != nullptr && chunk_manager.GetLod(neighbour->GetGlobalPosition().x, neighbour->GetGlobalPosition().z) == lod;
+		};
+		left = same_lod(left) ? left : nullptr;
+		right = same_lod(right) ? right : nullptr;
+		back = same_lod(back) ? back : nullptr;
+		front = same_lod(front) ? front : nullptr;
+		back_left = back_right = front_left = front_right = nullptr;	// ambient occlusion is only in full detail
+		Downsample(lod, sections);
+	}
+
+	// borders from neighbours, chunks outside of loaded area are treated as air,
+	// layer around meshed ones is needed too, ambient occlusion of side faces looks one block up and down
+	for (int y = capture_begin; y < capture_end; ++y)
+	{
+		if (!captured(y))
+			continue;
+		for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+		{
+			blocks_[GetIndex(-1, y, z)] = left ? left->GetBlock(CHUNK_SIZE_X - 1, y, z) : BlockId::Air;
+			blocks_[GetIndex(CHUNK_SIZE_X, y, z)] = right ? right->GetBlock(0, y, z) : BlockId::Air;
+		}
+		for (int x = 0; x < CHUNK_SIZE_X; ++x)
+		{
+			blocks_[GetIndex(x, y, -1)] = back ? back->GetBlock(x, y, CHUNK_SIZE_Z - 1) : BlockId::Air;
+			blocks_[GetIndex(x, y, CHUNK_SIZE_Z)] = front ? front->GetBlock(x, y, 0) : BlockId::Air;
+		}
+		blocks_[GetIndex(-1, y, -1)] = back_left ? back_left->GetBlock(CHUNK_SIZE_X - 1, y, CHUNK_SIZE_Z - 1) : BlockId::Air;
+		blocks_[GetIndex(CHUNK_SIZE_X, y, -1)] = back_right ? back_right->GetBlock(0, y, CHUNK_SIZE_Z - 1) : BlockId::Air;
+		blocks_[GetIndex(-1, y, CHUNK_SIZE_Z)] = front_left ? front_left->GetBlock(CHUNK_SIZE_X - 1, y, 0) : BlockId::Air;
+		blocks_[GetIndex(CHUNK_SIZE_X, y, CHUNK_SIZE_Z)] = front_right ? front_right->GetBlock(0, y, 0) : BlockId::Air;
+	}
+
+	if (lod > 1)
+	{
+		if (left)
+			DownsampleBorder(*left, -1, 0, sections);
+		if (right)
+			DownsampleBorder(*right, 1, 0, sections);
+		if (back)
+			DownsampleBorder(*back, 0, -1, sections);
+		if (front)
+			DownsampleBorder(*front, 0, 1, sections);
+	}
+
+	// solid section is fully hidden when every section around it is solid too
+	for (int section_y = 0; section_y < CHUNK_SECTION_COUNT; ++section_y)
+	{
+		bool occluded = section_states_[section_y] == SectionState::Solid &&
+			section_y + 1 < CHUNK_SECTION_COUNT && section_states_[section_y + 1] == SectionState::Solid &&
+			(section_y == 0 || section_states_[section_y - 1] == SectionState::Solid);
+
+		for (const Chunk* neighbour : { left, right, back, front })
+			occluded = occluded && neighbour != nullptr && neighbour->GetSection(section_y).GetState() == SectionState::Solid;
+
+		section_occluded_[section_y] = occluded;
+	}
+}
+
+// Every lod^3 cell is either air or one block: solid when at least half of it is non air (majority),
+// and then it takes the highest block in the cell, so grass stays on top of hills instead of dirt or stone.
+template <typename GetBlock>
+static BlockId DownsampleCell(int x_cell, int y_cell, int z_cell, int lod, const GetBlock& get_block)
+{
+	int non_air = 0;
+	BlockId top = BlockId::Air;
+	for (int y = y_cell + lod - 1; y >= y_cell; --y)
+		for (int z = z_cell; z < z_cell + lod; ++z)
+			for (int x = x_cell; x < x_cell + lod; ++x)
+			{
+				const BlockId block = get_block(x, y, z);
+				if (block == BlockId::Air)
+					continue;
+				if (non_air++ == 0)
+					top = block;
+			}
+	return non_air * 2 >= lod * lod * lod ? top : BlockId::Air;
+}
+
+void ChunkSnapshot::Downsample(int lod, uint16_t sections)
+{
+	const auto get_block = [this](int x, int y, int z) { return blocks_[GetIndex(x, y, z)]; };
+	for (int y_cell = mesh_y_begin_; y_cell < mesh_y_end_; y_cell += lod)
+	{
+		if (((sections >> (y_cell / SECTION_SIZE)) & 1) == 0)
+			continue;
+		for (int z_cell = 0; z_cell < CHUNK_SIZE_Z; z_cell += lod)
+			for (int x_cell = 0; x_cell < CHUNK_SIZE_X; x_cell += lod)
+			{
+				const BlockId cell = DownsampleCell(x_cell, y_cell, z_cell, lod, get_block);
+				for (int y = y_cell; y < y_cell + lod; ++y)
+					for (int z = z_cell; z < z_cell + lod; ++z)
+						std::fill_n(&blocks_[GetIndex(x_cell, y, z)], lod, cell);
+			}
+	}
+}
+
+// border layer gets cells of neighbour next to it, as neighbour downsamples them for its own mesh
+void ChunkSnapshot::DownsampleBorder(const Chunk& neighbour, int dx, int dz, uint16_t sections)
+{
+	const int lod = lod_;
+	const auto get_block = [&neighbour](int x, int y, int z) { return neighbour.GetBlock(x, y, z); };
+	const int x_cell = dx < 0 ? CHUNK_SIZE_X - lod : 0;	// used when dx != 0
+	const int z_cell = dz < 0 ? CHUNK_SIZE_Z - lod : 0;	// used when dz != 0
+	const int border_x = dx < 0 ? -1 : CHUNK_SIZE_X;
+	const int border_z = dz < 0 ? -1 : CHUNK_SIZE_Z;
+	const int length = dx != 0 ? CHUNK_SIZE_Z : CHUNK_SIZE_X;
+	for (int y_cell = mesh_y_begin_; y_cell < mesh_y_end_; y_cell += lod)
+	{
+		if (((sections >> (y_cell / SECTION_SIZE)) & 1) == 0)
+			continue;
+		for (int along = 0; along < length; along += lod)
+		{
+			const BlockId cell = dx != 0 ? DownsampleCell(x_cell, y_cell, along, lod, get_block) : DownsampleCell(along, y_cell, z_cell, lod, get_block);
+			for (int y = y_cell; y < y_cell + lod; ++y)
+				for (int i = along; i < along + lod; ++i)
+					blocks_[dx != 0 ? GetIndex(border_x, y, i) : GetIndex(i, y, border_z)] = cell;
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Chunk.h"
+#include <array>
+#include <vector>
+
+class ChunkManager;
+
+// Copy of chunk blocks together with 1 block border taken from its eight neighbours (and y = -1 / y = CHUNK_SIZE_Y layers),
+// stored in one contiguous buffer. Mesher works only on this copy, so it never has to go through ChunkManager::GetBlock
+// and does not care if chunk (or its neighbours) are edited while mesh is being built.
+// Coordinates are chunk local, valid range is -1 ... CHUNK_SIZE inclusive on each axis.
+// Only layers which can hold visible faces (GetMeshYBegin ... GetMeshYEnd, see HeightSummary) and one layer around them are captured,
+// rest of the buffer keeps whatever was there from previous chunk.
+// For LOD (lod > 1) blocks are replaced by lod^3 cells, each filled with one block (see Downsample), borders from neighbours
+// with different LOD are air, so chunk gets closed by walls (skirts) and no cracks are visible next to them.
+class ChunkSnapshot
+{
+public:
+	static const int SIZE_X = CHUNK_SIZE_X + 2;
+	static const int SIZE_Y = CHUNK_SIZE_Y + 2;
+	static const int SIZE_Z = CHUNK_SIZE_Z + 2;
+	static const int STRIDE_X = 1;
+	static const int STRIDE_Z = SIZE_X;
+	static const int STRIDE_Y = SIZE_X * SIZE_Z;
+	static const uint16_t ALL_SECTIONS = (1 << CHUNK_SECTION_COUNT) - 1;
+
+	ChunkSnapshot();
+	// sections is bit mask, only blocks needed to mesh those sections are captured (section states are captured always)
+	void Capture(const Chunk& chunk, const ChunkManager& chunk_manager, uint16_t sections = ALL_SECTIONS, int lod = 1);
+
+	inline int GetIndex(int x, int y, int z) const { return (x + 1) * STRIDE_X + (z + 1) * STRIDE_Z + (y + 1) * STRIDE_Y; }
+	inline BlockId GetBlock(int index) const { return blocks_[index]; }
+	inline BlockId GetBlock(int x, int y, int z) const { return blocks_[GetIndex(x, y, z)]; }
+	inline SectionState GetSectionState(int section_y) const { return section_states_[section_y]; }
+	// true when section is solid and every section around it is solid too, so none of its faces can be visible
+	inline bool IsSectionOccluded(int section_y) const { return section_occluded_[section_y]; }
+	// every block below begin is non transparent and surrounded by non transparent blocks, everything from end up is air
+	inline int GetMeshYBegin() const { return mesh_y_begin_; }
+	inline int GetMeshYEnd() const { return mesh_y_end_; }
+	inline int GetLod() const { return lod_; }
+private:
+	void Downsample(int lod, uint16_t sections);
+	void DownsampleBorder(const Chunk& neighbour, int dx, int dz, uint16_t sections);	// neighbour of the same LOD in direction dx / dz
+
+	std::vector<BlockId> blocks_;
+	std::array<SectionState, CHUNK_SECTION_COUNT> section_states_;
+	std::array<bool, CHUNK_SECTION_COUNT> section_occluded_;
+	int mesh_y_begin_;
+	int mesh_y_end_;
+	int lod_;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Chunk mesh vertex packed into single 32 bit word, position is chunk local (same layout is decoded in basic.vs and ray-closest-hit.rchit)
+// bits:  0 -  4 x (0 ... 16)
+//        5 - 13 y (0 ... 256)
+//       14 - 18 z (0 ... 16)
+//       19 - 21 face (Face enum)
+//       22 - 29 atlas tile
+//       30 - 31 ambient occlusion, 0 (corner fully occluded) ... 3 (not occluded)
+// Texture coordinates are not stored, shaders derive them from position and face, so texture repeats across merged (greedy) quads.
+// Every quad is 4 consecutive vertices, there are no per mesh indices, all meshes share one index buffer from BuildQuadIndices.
+namespace ChunkVertex
+{
+	const int X_SHIFT = 0;
+	const int Y_SHIFT = 5;
+	const int Z_SHIFT = 14;
+	const int FACE_SHIFT = 19;
+	const int TILE_SHIFT = 22;
+	const int AO_SHIFT = 30;
+
+	inline uint32_t Pack(int x, int y, int z, int face, int tile, int ao)
+	{
+		return uint32_t(x) << X_SHIFT | uint32_t(y) << Y_SHIFT | uint32_t(z) << Z_SHIFT | uint32_t(face) << FACE_SHIFT | uint32_t(tile) << TILE_SHIFT |
+			uint32_t(ao) << AO_SHIFT;
+	}
+
+	inline glm::uvec3 UnpackPosition(uint32_t vertex)
+	{
+		return glm::uvec3((vertex >> X_SHIFT) & 0x1f, (vertex >> Y_SHIFT) & 0x1ff, (vertex >> Z_SHIFT) & 0x1f);
+	}
+
+	inline int UnpackFace(uint32_t vertex) { return (vertex >> FACE_SHIFT) & 0x7; }
+	inline int UnpackTile(uint32_t vertex) { return (vertex >> TILE_SHIFT) & 0xff; }
+	inline int UnpackAo(uint32_t vertex) { return (vertex >> AO_SHIFT) & 0x3; }
+
+	// worst case for single chunk is every face of every block, e.g. checkerboard of water and leaves (transparent blocks
+	// of different kind do not cull each other), layers of mesh are concatenated and drawn with this one index buffer
+	const int MAX_QUADS = 16 * 256 * 16 * 6;
+
+	// two triangles per quad, 0 1 2, 2 3 0 (closest hit shader relies on this order)
+	inline std::vector<unsigned int> BuildQuadIndices(int quad_count)
+	{
+		std::vector<unsigned int> indices;
+		indices.reserve(quad_count * 6);
+		for (unsigned int i = 0; i < (unsigned int)quad_count * 4; i += 4)
+		{
+			indices.emplace_back(i);
+			indices.emplace_back(i + 1);
+			indices.emplace_back(i + 2);
+			indices.emplace_back(i + 2);
+			indices.emplace_back(i + 3);
+			indices.emplace_back(i);
+		}
+		return indices;
+	}
+}
@@ -0,0 +1,41 @@
+#include "ClimateCache.h"
+
+ClimateCache::ClimateCache(size_t capacity)
+	: slots_(capacity), tick_(0), builds_(0)
+{
+}
+
+std::shared_ptr<ClimateCache::Entry> ClimateCache::Acquire(int region_x, int region_z)
+{
+	const uint64_t key = (uint64_t(uint32_t(region_x)) << 32) | uint32_t(region_z);
+	std::lock_guard<std::mutex> lock(mutex_);
+	Slot* victim = &slots_[0];
+	for (Slot& slot : slots_)
+	{
+		if (slot.entry && slot.key == key)
+		{
+			slot.last_used = ++tick_;
+			return slot.entry;
+		}
+		if (!slot.entry || (victim->entry && slot.last_used < victim->last_used))
+			victim = &slot;
+	}
+	victim->key = key;
+	victim->last_used = ++tick_;
+	victim->entry = std::make_shared<Entry>();
+	++builds_;
+	return victim->entry;
+}
+
+void ClimateCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (Slot& slot : slots_)
+		slot.entry.reset();
+}
+
+size_t ClimateCache::GetBuildCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return builds_;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Continentalness and erosion of one region on coarse lattice (WorldGenerator noise step), lattice is aligned to world coordinates,
+// last row and column are first row and column of next region, so columns of region interpolate only from their own region.
+struct ClimateRegion
+{
+	int step = 0;
+	int size = 0;	// lattice points along each axis, REGION_SIZE / step + 1
+	std::vector<float> continentalness;	// x + z * size
+	std::vector<float> erosion;
+};
+
+// Climate channels vary on scales of thousands of blocks, so their octaves are evaluated once per region and kept here,
+// least recently used region is dropped when cache is full. Shared by all generating threads: lookup is short scan under mutex,
+// region is built outside of it (once, by first thread that needs it, others needing the same region wait), regions handed out
+// stay valid after they are dropped, so heap is touched only when new region is built.
+class ClimateCache
+{
+public:
+	static const int REGION_SIZE = 512;	// blocks, multiple of CHUNK_SIZE_X / CHUNK_SIZE_Z, so chunk never spans two regions
+
+	explicit ClimateCache(size_t capacity);
+
+	// build(ClimateRegion&) fills region of region_x, region_z (in regions, not blocks) when it is not cached
+	template<typename Build>
+	std::shared_ptr<const ClimateRegion> Get(int region_x, int region_z, Build&& build)
+	{
+		const std::shared_ptr<Entry> entry = Acquire(region_x, region_z);
+		std::call_once(entry->built, [&]() { build(entry->region); });
+		return std::shared_ptr<const ClimateRegion>(entry, &entry->region);
+	}
+	void Clear();	// climate parameters changed, regions already handed out are not affected
+	size_t GetBuildCount() const;	// regions built since creation, for benchmark
+private:
+	struct Entry
+	{
+		ClimateRegion region;
+		std::once_flag built;
+	};
+	struct Slot
+	{
+		uint64_t key = 0;
+		uint64_t last_used = 0;
+		std::shared_ptr<Entry> entry;	// nullptr when slot is free
+	};
+	std::shared_ptr<Entry> Acquire(int region_x, int region_z);
+
+	mutable std::mutex mutex_;
+	std::vector<Slot> slots_;	// capacity is small, linear scan is faster than any map
+	uint64_t tick_;
+	size_t builds_;
+};
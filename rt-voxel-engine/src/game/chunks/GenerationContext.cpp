@@ -0,0 +1,26 @@
+#include "GenerationContext.h"
+#include "Chunk.h"
+#include <memory>
+
+GenerationContext::GenerationContext()
+{
+	const int columns = CHUNK_SIZE_X * CHUNK_SIZE_Z;
+	const int lattice_columns = (CHUNK_SIZE_X + 2) * (CHUNK_SIZE_Z + 2);	// more than lattice of any noise step > 1 needs
+	channels.reserve(columns * 3);
+	lattice.reserve(lattice_columns * 2);
+	splines.reserve(columns * 3);
+	tree_columns.reserve(columns);
+	spans.reserve(columns * MAX_COLUMN_SPANS);
+	section_blocks.reserve(SECTION_VOLUME);
+	density.reserve((CHUNK_SIZE_X / DENSITY_STEP_XZ + 1) * (CHUNK_SIZE_Y / DENSITY_STEP_Y + 2) * (CHUNK_SIZE_Z / DENSITY_STEP_XZ + 1) *
+		static_cast<int>(DensityNoise::COUNT));
+	trees.reserve(columns * 9);		// every column of chunk and its neighbours, more than any tree radius can reach
+	neighbour_heights.reserve(columns);
+	runs.reserve(SECTION_VOLUME);	// usual baked chunk has far fewer runs, bigger ones grow it once
+}
+
+GenerationContext& GenerationContext::ForCurrentThread()
+{
+	thread_local std::unique_ptr<GenerationContext> context = std::make_unique<GenerationContext>();
+	return *context;
+}
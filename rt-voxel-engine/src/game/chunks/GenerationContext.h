@@ -0,0 +1,39 @@
+#pragma once
+
+#include "WorldGenerator.h"
+#include "BlockStorage.h"
+#include "game/blocks/BlockId.h"
+#include <cstdint>
+#include <vector>
+
+// tree found by decoration stage, chunk local coordinates (can be outside of chunk, tree of neighbour)
+struct DecorationTree
+{
+	int x, z;
+	int base;	// grass block under trunk
+};
+
+// Scratch memory for chunk generation: WorldGenerator::GenerateHeights and Chunk generation stages.
+// WorldGenerator is only configuration read by all threads at once, everything written while generating lives here,
+// one context per thread, sized for one chunk when created, so generating chunks does no heap allocations (same as MeshingArena).
+class GenerationContext
+{
+public:
+	GenerationContext();
+	static GenerationContext& ForCurrentThread();
+
+	// GenerateHeights, per column of grid
+	std::vector<float> channels;		// continentalness, erosion, peaks and valeys
+	std::vector<float> lattice;			// continentalness and erosion on coarse lattice
+	std::vector<float> splines;			// spline of each channel
+	std::vector<uint8_t> tree_columns;
+	// Chunk::GenerateTerrain
+	std::vector<BlockSpan> spans;		// MAX_COLUMN_SPANS per column
+	std::vector<BlockId> section_blocks;
+	std::vector<float> density;			// overhang and cave lattice (DENSITY_TERRAIN)
+	// Chunk::GenerateDecoration
+	std::vector<DecorationTree> trees;
+	std::vector<HeightPayload> neighbour_heights;	// of baked neighbour, it has none of its own
+	// Chunk::ReadBaked
+	std::vector<BlockRun> runs;			// of whole chunk, section after section
+};
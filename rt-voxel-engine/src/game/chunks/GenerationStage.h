@@ -0,0 +1,14 @@
+#pragma once
+
+// Chunk is generated in stages, stage N runs only when all 8 neighbours are at least at stage N - 1 (ChunkManager::GenerateArea),
+// so stage can read neighbours (e.g. trees crossing chunk border), it only ever writes its own blocks
+enum class GenerationStage : unsigned char
+{
+	Empty = 0,
+	Terrain,	// column heights, stone and water
+	Surface,	// sand, dirt, grass
+	Decoration,	// trees, also ones growing from neighbours
+	Lit,		// neighbours are final, so meshing (face culling, baked AO) can read them, light itself is traced by renderer
+};
+// rings of partially generated chunks needed around lit ones
+const int GENERATION_MARGIN = static_cast<int>(GenerationStage::Lit) - static_cast<int>(GenerationStage::Terrain);
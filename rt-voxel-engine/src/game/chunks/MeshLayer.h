@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Chunk mesh is split by how renderer has to treat hits on the block, every layer is separate BLAS geometry
+// and geometry index is the layer (closest hit shader relies on it, so there are always all layers, even empty)
+enum class MeshLayer : unsigned char
+{
+	Opaque = 0,
+	AlphaTested,	// leaves
+	Refractive,		// water
+	COUNT
+};
+const int MESH_LAYER_COUNT = static_cast<int>(MeshLayer::COUNT);
+
+using LayeredVertices = std::array<std::vector<uint32_t>, MESH_LAYER_COUNT>;
+// first vertex of every layer in vertices concatenated layer after layer, last one is total vertex count
+using MeshLayerOffsets = std::array<uint32_t, MESH_LAYER_COUNT + 1>;
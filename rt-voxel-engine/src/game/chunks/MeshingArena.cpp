@@ -0,0 +1,14 @@
+#include "MeshingArena.h"
+#include <memory>
+
+MeshingArena::MeshingArena()
+{
+	vertices.reserve(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z * 4);
+}
+
+MeshingArena& MeshingArena::ForCurrentThread()
+{
+	// on heap, whole arena is too big for thread local storage
+	thread_local std::unique_ptr<MeshingArena> arena = std::make_unique<MeshingArena>();
+	return *arena;
+}
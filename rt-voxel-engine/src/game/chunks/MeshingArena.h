@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ChunkSnapshot.h"
+#include "ChunkMesher.h"
+#include <cstdint>
+#include <vector>
+
+// Scratch memory for Chunk::BuildMesh: snapshot, mesher working memory and output vertices.
+// One arena per thread, reused by every BuildMesh call on that thread, so after first few chunks meshing does no heap allocations
+// (vertices only grow to the biggest mesh seen, clear() keeps capacity). Replaces old SharedBufferPool.
+class MeshingArena
+{
+public:
+	MeshingArena();
+	static MeshingArena& ForCurrentThread();
+
+	ChunkSnapshot snapshot;
+	ChunkMesher::Scratch mesher_scratch;
+	LayeredVertices layers;	// mesher output of chunks without section cache (not edited ones)
+	std::vector<uint32_t> vertices;
+};
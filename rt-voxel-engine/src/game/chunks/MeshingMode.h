@@ -0,0 +1,8 @@
+#pragma once
+
+// see ChunkMesher
+enum class MeshingMode : unsigned char
+{
+	Naive = 0,	// one quad per visible block face
+	Greedy		// visible faces of same block merged into rectangles
+};
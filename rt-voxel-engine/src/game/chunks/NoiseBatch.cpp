@@ -0,0 +1,555 @@
+#include "NoiseBatch.h"
+#include <array>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NOISE_BATCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define NOISE_TARGET_SSE41
+#define NOISE_TARGET_AVX2
+#else
+// only these functions are compiled for the wider ISA, rest of the engine stays on baseline (and without FMA contraction)
+#define NOISE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define NOISE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	// constants of FastNoiseLite, it keeps them private
+	const int PRIME_X = 501125321;
+	const int PRIME_Y = 1136930381;
+	const int PRIME_Z = 1720413743;
+	const int HASH_MULTIPLIER = 0x27d4eb2d;
+	const float PERLIN_SCALE = 1.4247691104677813f;
+	const float PERLIN_SCALE_3D = 0.964921414852142333984375f;
+
+	// FastNoiseLite::Lookup::Gradients2D is 128 (x, y) pairs, these 24 repeated 5 times and GRADIENTS_TAIL
+	const float GRADIENTS_24[48] =
+	{
+		0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+		0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+		0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+		-0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+		-0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+		-0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+	};
+
+	const float GRADIENTS_TAIL[16] =
+	{
+		0.38268343236509f, 0.923879532511287f, 0.923879532511287f, 0.38268343236509f, 0.923879532511287f, -0.38268343236509f, 0.38268343236509f, -0.923879532511287f,
+		-0.38268343236509f, -0.923879532511287f, -0.923879532511287f, -0.38268343236509f, -0.923879532511287f, 0.38268343236509f, -0.38268343236509f, 0.923879532511287f,
+	};
+
+	// indexed by hash & 254 (x) and hash & 254 | 1 (y), same as in FastNoiseLite::GradCoord
+	const std::array<float, 256> GRADIENTS = []()
+	{
+		std::array<float, 256> gradients;
+		for (int i = 0; i < 240; ++i)
+			gradients[i] = GRADIENTS_24[i % 48];
+		for (int i = 240; i < 256; ++i)
+			gradients[i] = GRADIENTS_TAIL[i - 240];
+		return gradients;
+	}();
+
+	// FastNoiseLite::Lookup::Gradients3D is 64 (x, y, z, 0) quads, 12 cube edges repeated 5 times and GRADIENTS_3D_TAIL
+	const float GRADIENTS_3D_12[48] =
+	{
+		0, 1, 1, 0,  0, -1, 1, 0,  0, 1, -1, 0,  0, -1, -1, 0,
+		1, 0, 1, 0,  -1, 0, 1, 0,  1, 0, -1, 0,  -1, 0, -1, 0,
+		1, 1, 0, 0,  -1, 1, 0, 0,  1, -1, 0, 0,  -1, -1, 0, 0,
+	};
+
+	const float GRADIENTS_3D_TAIL[16] =
+	{
+		1, 1, 0, 0,  0, -1, 1, 0,  -1, 1, 0, 0,  0, -1, -1, 0,
+	};
+
+	// indexed by hash & 252 (x), | 1 (y) and | 2 (z), same as in FastNoiseLite::GradCoord
+	const std::array<float, 256> GRADIENTS_3D = []()
+	{
+		std::array<float, 256> gradients;
+		for (int i = 0; i < 240; ++i)
+			gradients[i] = GRADIENTS_3D_12[i % 48];
+		for (int i = 240; i < 256; ++i)
+			gradients[i] = GRADIENTS_3D_TAIL[i - 240];
+		return gradients;
+	}();
+
+	inline int FastFloor(float f) { return f >= 0 ? (int)f : (int)f - 1; }
+	inline float InterpQuintic(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+	inline float Lerp(float a, float b, float t) { return a + t * (b - a); }
+
+	inline int GradientIndex(int seed, int x_primed, int y_primed)
+	{
+		int hash = (seed ^ x_primed ^ y_primed) * HASH_MULTIPLIER;
+		hash ^= hash >> 15;
+		return hash & (127 << 1);
+	}
+
+	inline float GradCoord(int seed, int x_primed, int y_primed, float xd, float yd)
+	{
+		const int index = GradientIndex(seed, x_primed, y_primed);
+		return xd * GRADIENTS[index] + yd * GRADIENTS[index | 1];
+	}
+
+	inline float SinglePerlin(int seed, float x, float y)
+	{
+		int x0 = FastFloor(x);
+		int y0 = FastFloor(y);
+
+		float xd0 = (float)(x - x0);
+		float yd0 = (float)(y - y0);
+		float xd1 = xd0 - 1;
+		float yd1 = yd0 - 1;
+
+		float xs = InterpQuintic(xd0);
+		float ys = InterpQuintic(yd0);
+
+		// multiplication overflow is intended, as in FastNoiseLite (unsigned to avoid UB)
+		x0 = (int)((unsigned)x0 * (unsigned)PRIME_X);
+		y0 = (int)((unsigned)y0 * (unsigned)PRIME_Y);
+		int x1 = (int)((unsigned)x0 + (unsigned)PRIME_X);
+		int y1 = (int)((unsigned)y0 + (unsigned)PRIME_Y);
+
+		float xf0 = Lerp(GradCoord(seed, x0, y0, xd0, yd0), GradCoord(seed, x1, y0, xd1, yd0), xs);
+		float xf1 = Lerp(GradCoord(seed, x0, y1, xd0, yd1), GradCoord(seed, x1, y1, xd1, yd1), xs);
+
+		return Lerp(xf0, xf1, ys) * PERLIN_SCALE;
+	}
+
+	inline float GradCoord3D(int seed, int x_primed, int y_primed, int z_primed, float xd, float yd, float zd)
+	{
+		int hash = (seed ^ x_primed ^ y_primed ^ z_primed) * HASH_MULTIPLIER;
+		hash ^= hash >> 15;
+		const int index = hash & (63 << 2);
+		return xd * GRADIENTS_3D[index] + yd * GRADIENTS_3D[index | 1] + zd * GRADIENTS_3D[index | 2];
+	}
+
+	inline float SinglePerlin3D(int seed, float x, float y, float z)
+	{
+		int x0 = FastFloor(x);
+		int y0 = FastFloor(y);
+		int z0 = FastFloor(z);
+
+		float xd0 = (float)(x - x0);
+		float yd0 = (float)(y - y0);
+		float zd0 = (float)(z - z0);
+		float xd1 = xd0 - 1;
+		float yd1 = yd0 - 1;
+		float zd1 = zd0 - 1;
+
+		float xs = InterpQuintic(xd0);
+		float ys = InterpQuintic(yd0);
+		float zs = InterpQuintic(zd0);
+
+		x0 = (int)((unsigned)x0 * (unsigned)PRIME_X);
+		y0 = (int)((unsigned)y0 * (unsigned)PRIME_Y);
+		z0 = (int)((unsigned)z0 * (unsigned)PRIME_Z);
+		int x1 = (int)((unsigned)x0 + (unsigned)PRIME_X);
+		int y1 = (int)((unsigned)y0 + (unsigned)PRIME_Y);
+		int z1 = (int)((unsigned)z0 + (unsigned)PRIME_Z);
+
+		float xf00 = Lerp(GradCoord3D(seed, x0, y0, z0, xd0, yd0, zd0), GradCoord3D(seed, x1, y0, z0, xd1, yd0, zd0), xs);
+		float xf10 = Lerp(GradCoord3D(seed, x0, y1, z0, xd0, yd1, zd0), GradCoord3D(seed, x1, y1, z0, xd1, yd1, zd0), xs);
+		float xf01 = Lerp(GradCoord3D(seed, x0, y0, z1, xd0, yd0, zd1), GradCoord3D(seed, x1, y0, z1, xd1, yd0, zd1), xs);
+		float xf11 = Lerp(GradCoord3D(seed, x0, y1, z1, xd0, yd1, zd1), GradCoord3D(seed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+		float yf0 = Lerp(xf00, xf10, ys);
+		float yf1 = Lerp(xf01, xf11, ys);
+
+		return Lerp(yf0, yf1, zs) * PERLIN_SCALE_3D;
+	}
+
+	void AccumulateColumnScalar(int seed, float x, int y, float z, int step_y, int begin, int count, float frequency, float amplitude, float* out)
+	{
+		for (int i = begin; i < count; ++i)
+			out[i] += SinglePerlin3D(seed, x, (y + i * step_y) * frequency, z) * amplitude;
+	}
+
+	// row of count columns starting at x, step apart, from index begin (lanes before it are done by SIMD)
+	void AccumulateRowScalar(int seed, int x, float y, int step, int begin, int count, float frequency, float amplitude, float* out)
+	{
+		for (int i = begin; i < count; ++i)
+			out[i] += SinglePerlin(seed, (x + i * step) * frequency, y) * amplitude;
+	}
+
+#ifdef NOISE_BATCH_X86
+	NOISE_TARGET_SSE41 int AccumulateRowSSE41(int seed, int x, float y, int step, int count, float frequency, float amplitude, float* out)
+	{
+		// row is shared by all lanes
+		const int y0_int = FastFloor(y);
+		const float yd0_scalar = (float)(y - y0_int);
+		const __m128 yd0 = _mm_set1_ps(yd0_scalar);
+		const __m128 yd1 = _mm_set1_ps(yd0_scalar - 1);
+		const __m128 ys = _mm_set1_ps(InterpQuintic(yd0_scalar));
+		const __m128i y0 = _mm_set1_epi32((int)((unsigned)y0_int * (unsigned)PRIME_Y));
+		const __m128i y1 = _mm_set1_epi32((int)((unsigned)y0_int * (unsigned)PRIME_Y + (unsigned)PRIME_Y));
+
+		const __m128i seed_v = _mm_set1_epi32(seed);
+		const __m128i prime_x = _mm_set1_epi32(PRIME_X);
+		const __m128i hash_multiplier = _mm_set1_epi32(HASH_MULTIPLIER);
+		const __m128i index_mask = _mm_set1_epi32(127 << 1);
+		const __m128 frequency_v = _mm_set1_ps(frequency);
+		const __m128 amplitude_v = _mm_set1_ps(amplitude);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 six = _mm_set1_ps(6.0f);
+		const __m128 fifteen = _mm_set1_ps(15.0f);
+		const __m128 ten = _mm_set1_ps(10.0f);
+		const __m128 scale = _mm_set1_ps(PERLIN_SCALE);
+		const __m128i lane_offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(step));
+
+		alignas(16) int indices[4];
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i column = _mm_add_epi32(_mm_set1_epi32(x + i * step), lane_offsets);
+			const __m128 xf = _mm_mul_ps(_mm_cvtepi32_ps(column), frequency_v);
+
+			// FastFloor, truncation minus one for negative values (also for negative whole numbers, as FastNoiseLite does)
+			__m128i x0 = _mm_cvttps_epi32(xf);
+			x0 = _mm_add_epi32(x0, _mm_castps_si128(_mm_cmplt_ps(xf, zero)));
+			const __m128 xd0 = _mm_sub_ps(xf, _mm_cvtepi32_ps(x0));
+			const __m128 xd1 = _mm_sub_ps(xd0, one);
+			const __m128 xs = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(xd0, xd0), xd0),
+				_mm_add_ps(_mm_mul_ps(xd0, _mm_sub_ps(_mm_mul_ps(xd0, six), fifteen)), ten));
+
+			x0 = _mm_mullo_epi32(x0, prime_x);
+			const __m128i x1 = _mm_add_epi32(x0, prime_x);
+
+			__m128 corners[4];
+			const __m128i corner_x[4] = { x0, x1, x0, x1 };
+			const __m128i corner_y[4] = { y0, y0, y1, y1 };
+			const __m128 corner_xd[4] = { xd0, xd1, xd0, xd1 };
+			const __m128 corner_yd[4] = { yd0, yd0, yd1, yd1 };
+			for (int corner = 0; corner < 4; ++corner)
+			{
+				__m128i hash = _mm_mullo_epi32(_mm_xor_si128(_mm_xor_si128(seed_v, corner_x[corner]), corner_y[corner]), hash_multiplier);
+				hash = _mm_xor_si128(hash, _mm_srai_epi32(hash, 15));
+				_mm_store_si128((__m128i*)indices, _mm_and_si128(hash, index_mask));
+				// no gather in SSE
+				const __m128 xg = _mm_setr_ps(GRADIENTS[indices[0]], GRADIENTS[indices[1]], GRADIENTS[indices[2]], GRADIENTS[indices[3]]);
+				const __m128 yg = _mm_setr_ps(GRADIENTS[indices[0] | 1], GRADIENTS[indices[1] | 1], GRADIENTS[indices[2] | 1], GRADIENTS[indices[3] | 1]);
+				corners[corner] = _mm_add_ps(_mm_mul_ps(corner_xd[corner], xg), _mm_mul_ps(corner_yd[corner], yg));
+			}
+
+			const __m128 xf0 = _mm_add_ps(corners[0], _mm_mul_ps(xs, _mm_sub_ps(corners[1], corners[0])));
+			const __m128 xf1 = _mm_add_ps(corners[2], _mm_mul_ps(xs, _mm_sub_ps(corners[3], corners[2])));
+			const __m128 noise = _mm_mul_ps(_mm_add_ps(xf0, _mm_mul_ps(ys, _mm_sub_ps(xf1, xf0))), scale);
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(noise, amplitude_v)));
+		}
+		return i;
+	}
+
+	NOISE_TARGET_AVX2 int AccumulateRowAVX2(int seed, int x, float y, int step, int count, float frequency, float amplitude, float* out)
+	{
+		const int y0_int = FastFloor(y);
+		const float yd0_scalar = (float)(y - y0_int);
+		const __m256 yd0 = _mm256_set1_ps(yd0_scalar);
+		const __m256 yd1 = _mm256_set1_ps(yd0_scalar - 1);
+		const __m256 ys = _mm256_set1_ps(InterpQuintic(yd0_scalar));
+		const __m256i y0 = _mm256_set1_epi32((int)((unsigned)y0_int * (unsigned)PRIME_Y));
+		const __m256i y1 = _mm256_set1_epi32((int)((unsigned)y0_int * (unsigned)PRIME_Y + (unsigned)PRIME_Y));
+
+		const __m256i seed_v = _mm256_set1_epi32(seed);
+		const __m256i prime_x = _mm256_set1_epi32(PRIME_X);
+		const __m256i hash_multiplier = _mm256_set1_epi32(HASH_MULTIPLIER);
+		const __m256i index_mask = _mm256_set1_epi32(127 << 1);
+		const __m256i one_i = _mm256_set1_epi32(1);
+		const __m256 frequency_v = _mm256_set1_ps(frequency);
+		const __m256 amplitude_v = _mm256_set1_ps(amplitude);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 six = _mm256_set1_ps(6.0f);
+		const __m256 fifteen = _mm256_set1_ps(15.0f);
+		const __m256 ten = _mm256_set1_ps(10.0f);
+		const __m256 scale = _mm256_set1_ps(PERLIN_SCALE);
+		const __m256i lane_offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step));
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i column = _mm256_add_epi32(_mm256_set1_epi32(x + i * step), lane_offsets);
+			const __m256 xf = _mm256_mul_ps(_mm256_cvtepi32_ps(column), frequency_v);
+
+			__m256i x0 = _mm256_cvttps_epi32(xf);
+			x0 = _mm256_add_epi32(x0, _mm256_castps_si256(_mm256_cmp_ps(xf, zero, _CMP_LT_OQ)));
+			const __m256 xd0 = _mm256_sub_ps(xf, _mm256_cvtepi32_ps(x0));
+			const __m256 xd1 = _mm256_sub_ps(xd0, one);
+			const __m256 xs = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(xd0, xd0), xd0),
+				_mm256_add_ps(_mm256_mul_ps(xd0, _mm256_sub_ps(_mm256_mul_ps(xd0, six), fifteen)), ten));
+
+			x0 = _mm256_mullo_epi32(x0, prime_x);
+			const __m256i x1 = _mm256_add_epi32(x0, prime_x);
+
+			__m256 corners[4];
+			const __m256i corner_x[4] = { x0, x1, x0, x1 };
+			const __m256i corner_y[4] = { y0, y0, y1, y1 };
+			const __m256 corner_xd[4] = { xd0, xd1, xd0, xd1 };
+			const __m256 corner_yd[4] = { yd0, yd0, yd1, yd1 };
+			for (int corner = 0; corner < 4; ++corner)
+			{
+				__m256i hash = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(seed_v, corner_x[corner]), corner_y[corner]), hash_multiplier);
+				hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+				const __m256i index = _mm256_and_si256(hash, index_mask);
+				const __m256 xg = _mm256_i32gather_ps(GRADIENTS.data(), index, 4);
+				const __m256 yg = _mm256_i32gather_ps(GRADIENTS.data(), _mm256_or_si256(index, one_i), 4);
+				corners[corner] = _mm256_add_ps(_mm256_mul_ps(corner_xd[corner], xg), _mm256_mul_ps(corner_yd[corner], yg));
+			}
+
+			const __m256 xf0 = _mm256_add_ps(corners[0], _mm256_mul_ps(xs, _mm256_sub_ps(corners[1], corners[0])));
+			const __m256 xf1 = _mm256_add_ps(corners[2], _mm256_mul_ps(xs, _mm256_sub_ps(corners[3], corners[2])));
+			const __m256 noise = _mm256_mul_ps(_mm256_add_ps(xf0, _mm256_mul_ps(ys, _mm256_sub_ps(xf1, xf0))), scale);
+			_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(noise, amplitude_v)));
+		}
+		return i;
+	}
+
+	// x and z are shared by all lanes, so only y part of hash and gradient differs per lane
+	struct ColumnAxis
+	{
+		int primed0, primed1;
+		float d0, d1, s;
+
+		ColumnAxis(float f, int prime)
+		{
+			const int floor = FastFloor(f);
+			d0 = (float)(f - floor);
+			d1 = d0 - 1;
+			s = InterpQuintic(d0);
+			primed0 = (int)((unsigned)floor * (unsigned)prime);
+			primed1 = (int)((unsigned)primed0 + (unsigned)prime);
+		}
+	};
+
+	NOISE_TARGET_SSE41 int AccumulateColumnSSE41(int seed, float x, int y, float z, int step_y, int count, float frequency, float amplitude, float* out)
+	{
+		const ColumnAxis axis_x(x, PRIME_X), axis_z(z, PRIME_Z);
+		const __m128i hash_multiplier = _mm_set1_epi32(HASH_MULTIPLIER);
+		const __m128i index_mask = _mm_set1_epi32(63 << 2);
+		const __m128i prime_y = _mm_set1_epi32(PRIME_Y);
+		const __m128 frequency_v = _mm_set1_ps(frequency);
+		const __m128 amplitude_v = _mm_set1_ps(amplitude);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 six = _mm_set1_ps(6.0f);
+		const __m128 fifteen = _mm_set1_ps(15.0f);
+		const __m128 ten = _mm_set1_ps(10.0f);
+		const __m128 scale = _mm_set1_ps(PERLIN_SCALE_3D);
+		const __m128 xs = _mm_set1_ps(axis_x.s);
+		const __m128 zs = _mm_set1_ps(axis_z.s);
+		const __m128i lane_offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(step_y));
+
+		// seed ^ x ^ z of each of 4 (x, z) corner pairs, y is xored per lane
+		const int corner_x[4] = { axis_x.primed0, axis_x.primed1, axis_x.primed0, axis_x.primed1 };
+		const int corner_z[4] = { axis_z.primed0, axis_z.primed0, axis_z.primed1, axis_z.primed1 };
+		const float corner_xd[4] = { axis_x.d0, axis_x.d1, axis_x.d0, axis_x.d1 };
+		const float corner_zd[4] = { axis_z.d0, axis_z.d0, axis_z.d1, axis_z.d1 };
+
+		alignas(16) int indices[4];
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i row = _mm_add_epi32(_mm_set1_epi32(y + i * step_y), lane_offsets);
+			const __m128 yf = _mm_mul_ps(_mm_cvtepi32_ps(row), frequency_v);
+			__m128i y0 = _mm_cvttps_epi32(yf);
+			y0 = _mm_add_epi32(y0, _mm_castps_si128(_mm_cmplt_ps(yf, zero)));
+			const __m128 yd0 = _mm_sub_ps(yf, _mm_cvtepi32_ps(y0));
+			const __m128 yd1 = _mm_sub_ps(yd0, one);
+			const __m128 ys = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(yd0, yd0), yd0),
+				_mm_add_ps(_mm_mul_ps(yd0, _mm_sub_ps(_mm_mul_ps(yd0, six), fifteen)), ten));
+			y0 = _mm_mullo_epi32(y0, prime_y);
+			const __m128i y1 = _mm_add_epi32(y0, prime_y);
+
+			// corners[xz pair][y0 or y1]
+			__m128 corners[4][2];
+			for (int pair = 0; pair < 4; ++pair)
+			{
+				const __m128i seed_xz = _mm_set1_epi32(seed ^ corner_x[pair] ^ corner_z[pair]);
+				const __m128 xd = _mm_set1_ps(corner_xd[pair]);
+				const __m128 zd = _mm_set1_ps(corner_zd[pair]);
+				for (int corner_y = 0; corner_y < 2; ++corner_y)
+				{
+					__m128i hash = _mm_mullo_epi32(_mm_xor_si128(seed_xz, corner_y == 0 ? y0 : y1), hash_multiplier);
+					hash = _mm_xor_si128(hash, _mm_srai_epi32(hash, 15));
+					_mm_store_si128((__m128i*)indices, _mm_and_si128(hash, index_mask));
+					const __m128 xg = _mm_setr_ps(GRADIENTS_3D[indices[0]], GRADIENTS_3D[indices[1]], GRADIENTS_3D[indices[2]], GRADIENTS_3D[indices[3]]);
+					const __m128 yg = _mm_setr_ps(GRADIENTS_3D[indices[0] | 1], GRADIENTS_3D[indices[1] | 1], GRADIENTS_3D[indices[2] | 1], GRADIENTS_3D[indices[3] | 1]);
+					const __m128 zg = _mm_setr_ps(GRADIENTS_3D[indices[0] | 2], GRADIENTS_3D[indices[1] | 2], GRADIENTS_3D[indices[2] | 2], GRADIENTS_3D[indices[3] | 2]);
+					corners[pair][corner_y] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xd, xg), _mm_mul_ps(corner_y == 0 ? yd0 : yd1, yg)), _mm_mul_ps(zd, zg));
+				}
+			}
+
+			// same lerp order as FastNoiseLite: x, then y, then z
+			const __m128 xf00 = _mm_add_ps(corners[0][0], _mm_mul_ps(xs, _mm_sub_ps(corners[1][0], corners[0][0])));
+			const __m128 xf10 = _mm_add_ps(corners[0][1], _mm_mul_ps(xs, _mm_sub_ps(corners[1][1], corners[0][1])));
+			const __m128 xf01 = _mm_add_ps(corners[2][0], _mm_mul_ps(xs, _mm_sub_ps(corners[3][0], corners[2][0])));
+			const __m128 xf11 = _mm_add_ps(corners[2][1], _mm_mul_ps(xs, _mm_sub_ps(corners[3][1], corners[2][1])));
+			const __m128 yf0 = _mm_add_ps(xf00, _mm_mul_ps(ys, _mm_sub_ps(xf10, xf00)));
+			const __m128 yf1 = _mm_add_ps(xf01, _mm_mul_ps(ys, _mm_sub_ps(xf11, xf01)));
+			const __m128 noise = _mm_mul_ps(_mm_add_ps(yf0, _mm_mul_ps(zs, _mm_sub_ps(yf1, yf0))), scale);
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(noise, amplitude_v)));
+		}
+		return i;
+	}
+
+	NOISE_TARGET_AVX2 int AccumulateColumnAVX2(int seed, float x, int y, float z, int step_y, int count, float frequency, float amplitude, float* out)
+	{
+		const ColumnAxis axis_x(x, PRIME_X), axis_z(z, PRIME_Z);
+		const __m256i hash_multiplier = _mm256_set1_epi32(HASH_MULTIPLIER);
+		const __m256i index_mask = _mm256_set1_epi32(63 << 2);
+		const __m256i prime_y = _mm256_set1_epi32(PRIME_Y);
+		const __m256i one_i = _mm256_set1_epi32(1);
+		const __m256i two_i = _mm256_set1_epi32(2);
+		const __m256 frequency_v = _mm256_set1_ps(frequency);
+		const __m256 amplitude_v = _mm256_set1_ps(amplitude);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 six = _mm256_set1_ps(6.0f);
+		const __m256 fifteen = _mm256_set1_ps(15.0f);
+		const __m256 ten = _mm256_set1_ps(10.0f);
+		const __m256 scale = _mm256_set1_ps(PERLIN_SCALE_3D);
+		const __m256 xs = _mm256_set1_ps(axis_x.s);
+		const __m256 zs = _mm256_set1_ps(axis_z.s);
+		const __m256i lane_offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step_y));
+
+		const int corner_x[4] = { axis_x.primed0, axis_x.primed1, axis_x.primed0, axis_x.primed1 };
+		const int corner_z[4] = { axis_z.primed0, axis_z.primed0, axis_z.primed1, axis_z.primed1 };
+		const float corner_xd[4] = { axis_x.d0, axis_x.d1, axis_x.d0, axis_x.d1 };
+		const float corner_zd[4] = { axis_z.d0, axis_z.d0, axis_z.d1, axis_z.d1 };
+
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i row = _mm256_add_epi32(_mm256_set1_epi32(y + i * step_y), lane_offsets);
+			const __m256 yf = _mm256_mul_ps(_mm256_cvtepi32_ps(row), frequency_v);
+			__m256i y0 = _mm256_cvttps_epi32(yf);
+			y0 = _mm256_add_epi32(y0, _mm256_castps_si256(_mm256_cmp_ps(yf, zero, _CMP_LT_OQ)));
+			const __m256 yd0 = _mm256_sub_ps(yf, _mm256_cvtepi32_ps(y0));
+			const __m256 yd1 = _mm256_sub_ps(yd0, one);
+			const __m256 ys = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(yd0, yd0), yd0),
+				_mm256_add_ps(_mm256_mul_ps(yd0, _mm256_sub_ps(_mm256_mul_ps(yd0, six), fifteen)), ten));
+			y0 = _mm256_mullo_epi32(y0, prime_y);
+			const __m256i y1 = _mm256_add_epi32(y0, prime_y);
+
+			__m256 corners[4][2];
+			for (int pair = 0; pair < 4; ++pair)
+			{
+				const __m256i seed_xz = _mm256_set1_epi32(seed ^ corner_x[pair] ^ corner_z[pair]);
+				const __m256 xd = _mm256_set1_ps(corner_xd[pair]);
+				const __m256 zd = _mm256_set1_ps(corner_zd[pair]);
+				for (int corner_y = 0; corner_y < 2; ++corner_y)
+				{
+					__m256i hash = _mm256_mullo_epi32(_mm256_xor_si256(seed_xz, corner_y == 0 ? y0 : y1), hash_multiplier);
+					hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+					const __m256i index = _mm256_and_si256(hash, index_mask);
+					const __m256 xg = _mm256_i32gather_ps(GRADIENTS_3D.data(), index, 4);
+					const __m256 yg = _mm256_i32gather_ps(GRADIENTS_3D.data(), _mm256_or_si256(index, one_i), 4);
+					const __m256 zg = _mm256_i32gather_ps(GRADIENTS_3D.data(), _mm256_or_si256(index, two_i), 4);
+					corners[pair][corner_y] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xd, xg), _mm256_mul_ps(corner_y == 0 ? yd0 : yd1, yg)), _mm256_mul_ps(zd, zg));
+				}
+			}
+
+			const __m256 xf00 = _mm256_add_ps(corners[0][0], _mm256_mul_ps(xs, _mm256_sub_ps(corners[1][0], corners[0][0])));
+			const __m256 xf10 = _mm256_add_ps(corners[0][1], _mm256_mul_ps(xs, _mm256_sub_ps(corners[1][1], corners[0][1])));
+			const __m256 xf01 = _mm256_add_ps(corners[2][0], _mm256_mul_ps(xs, _mm256_sub_ps(corners[3][0], corners[2][0])));
+			const __m256 xf11 = _mm256_add_ps(corners[2][1], _mm256_mul_ps(xs, _mm256_sub_ps(corners[3][1], corners[2][1])));
+			const __m256 yf0 = _mm256_add_ps(xf00, _mm256_mul_ps(ys, _mm256_sub_ps(xf10, xf00)));
+			const __m256 yf1 = _mm256_add_ps(xf01, _mm256_mul_ps(ys, _mm256_sub_ps(xf11, xf01)));
+			const __m256 noise = _mm256_mul_ps(_mm256_add_ps(yf0, _mm256_mul_ps(zs, _mm256_sub_ps(yf1, yf0))), scale);
+			_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(noise, amplitude_v)));
+		}
+		return i;
+	}
+
+	NoiseBatch::Isa DetectIsa()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		const bool sse41 = (info[2] & (1 << 19)) != 0;
+		const bool avx_os = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;	// OSXSAVE, AVX, ymm state enabled
+		__cpuid(info, 0);
+		bool avx2 = false;
+		if (info[0] >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = avx_os && (info[1] & (1 << 5)) != 0;
+		}
+#else
+		const bool sse41 = __builtin_cpu_supports("sse4.1");
+		const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2)
+			return NoiseBatch::Isa::AVX2;
+		if (sse41)
+			return NoiseBatch::Isa::SSE41;
+		return NoiseBatch::Isa::Scalar;
+	}
+#else
+	NoiseBatch::Isa DetectIsa()
+	{
+		return NoiseBatch::Isa::Scalar;
+	}
+#endif
+
+	const NoiseBatch::Isa SUPPORTED_ISA = DetectIsa();
+	NoiseBatch::Isa isa = SUPPORTED_ISA;
+}
+
+NoiseBatch::Isa NoiseBatch::GetIsa()
+{
+	return isa;
+}
+
+void NoiseBatch::SetIsa(Isa new_isa)
+{
+	isa = new_isa < SUPPORTED_ISA ? new_isa : SUPPORTED_ISA;
+}
+
+const char* NoiseBatch::GetIsaName(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::AVX2:
+		return "avx2";
+	case Isa::SSE41:
+		return "sse4.1";
+	default:
+		return "scalar";
+	}
+}
+
+void NoiseBatch::AccumulatePerlinGrid(int seed, int x, int z, int size_x, int size_z, float frequency, float amplitude, float* out, int step)
+{
+	for (int row = 0; row < size_z; ++row)
+	{
+		const float y = (z + row * step) * frequency;
+		float* row_out = out + row * size_x;
+		int done = 0;
+#ifdef NOISE_BATCH_X86
+		if (isa == Isa::AVX2)
+			done = AccumulateRowAVX2(seed, x, y, step, size_x, frequency, amplitude, row_out);
+		else if (isa == Isa::SSE41)
+			done = AccumulateRowSSE41(seed, x, y, step, size_x, frequency, amplitude, row_out);
+#endif
+		AccumulateRowScalar(seed, x, y, step, done, size_x, frequency, amplitude, row_out);
+	}
+}
+
+void NoiseBatch::AccumulatePerlinColumn(int seed, int x, int y, int z, int size_y, int step_y, float frequency, float amplitude, float* out)
+{
+	const float xf = x * frequency;
+	const float zf = z * frequency;
+	int done = 0;
+#ifdef NOISE_BATCH_X86
+	if (isa == Isa::AVX2)
+		done = AccumulateColumnAVX2(seed, xf, y, zf, step_y, size_y, frequency, amplitude, out);
+	else if (isa == Isa::SSE41)
+		done = AccumulateColumnSSE41(seed, xf, y, zf, step_y, size_y, frequency, amplitude, out);
+#endif
+	AccumulateColumnScalar(seed, xf, y, zf, step_y, done, size_y, frequency, amplitude, out);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Batched 2D Perlin noise for WorldGenerator, evaluates whole grid of columns (one octave) at once.
+// It is the same function as FastNoiseLite::GetNoise with NoiseType_Perlin, frequency 1 and no fractal (how WorldGenerator sets it up),
+// operations are done in the same order as FastNoiseLite::SinglePerlin, so results match GetNoise bit for bit (benchmark checks it).
+// Lanes: AVX2 (8 columns, gathered gradients), SSE4.1 (4 columns), picked at runtime by CPU, scalar fallback otherwise.
+namespace NoiseBatch
+{
+	enum class Isa { Scalar, SSE41, AVX2 };
+
+	Isa GetIsa();				// best supported by this CPU, unless lowered by SetIsa
+	void SetIsa(Isa isa);		// for comparison, clamped to what CPU supports
+	const char* GetIsaName(Isa isa);
+
+	// out[i] += amplitude * Perlin(seed, (x + i % size_x * step) * frequency, (z + i / size_x * step) * frequency), for i < size_x * size_z
+	// step > 1 samples coarse lattice, every step-th column and row
+	void AccumulatePerlinGrid(int seed, int x, int z, int size_x, int size_z, float frequency, float amplitude, float* out, int step = 1);
+
+	// 3D Perlin (FastNoiseLite::GetNoise(x, y, z), same setup as above), one vertical column of points, lanes go along y:
+	// out[i] += amplitude * Perlin(seed, x * frequency, (y + i * step_y) * frequency, z * frequency), for i < size_y
+	void AccumulatePerlinColumn(int seed, int x, int y, int z, int size_y, int step_y, float frequency, float amplitude, float* out);
+}
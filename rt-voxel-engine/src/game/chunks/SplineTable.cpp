@@ -0,0 +1,15 @@
+#include "SplineTable.h"
+
+void SplineTable::Evaluate(const float* x, float* out, int count) const
+{
+	const float* samples = samples_.data();
+	const float min_x = min_x_;
+	const float scale = scale_;
+	for (int i = 0; i < count; ++i)
+	{
+		const float position = std::min(std::max((x[i] - min_x) * scale, 0.0f), (float)SIZE);
+		const int index = (int)position;
+		const float t = position - index;
+		out[i] = samples[index] + t * (samples[index + 1] - samples[index]);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+// Terrain spline (WorldGenerator::SplineInterpolate) sampled into fixed size table when generator is constructed,
+// evaluated by linear interpolation of neighbour samples: no search over control points and no cos per column.
+// Error against the spline itself is below 0.01 of block for WorldGenerator splines (checked by benchmark).
+class SplineTable
+{
+public:
+	static const int SIZE = 1024;	// intervals, table holds SIZE + 1 samples
+
+	SplineTable() : min_x_(0.0f), scale_(0.0f) { samples_.fill(0.0f); }
+
+	// spline is sampled only on [min_x, max_x], outside of it value is clamped (as SplineInterpolate does)
+	template <typename Spline>
+	void Build(float min_x, float max_x, Spline spline)
+	{
+		min_x_ = min_x;
+		scale_ = SIZE / (max_x - min_x);
+		for (int i = 0; i <= SIZE; ++i)
+			samples_[i] = spline(min_x + (max_x - min_x) * i / SIZE);
+		samples_[SIZE + 1] = samples_[SIZE];	// so max_x can read next sample too
+	}
+
+	inline float Evaluate(float x) const
+	{
+		const float position = std::min(std::max((x - min_x_) * scale_, 0.0f), (float)SIZE);
+		const int i = (int)position;
+		const float t = position - i;
+		return samples_[i] + t * (samples_[i + 1] - samples_[i]);
+	}
+
+	// branch free, compiler vectorizes it (gather for samples with AVX2)
+	void Evaluate(const float* x, float* out, int count) const;
+
+private:
+	float min_x_;
+	float scale_;
+	std::array<float, SIZE + 2> samples_;
+};
@@ -1,14 +1,69 @@
 #include "WorldGenerator.h"
+#include "GenerationContext.h"
+#include "NoiseBatch.h"
+#include "config.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
-#include <random>
+
+static const size_t CLIMATE_CACHE_REGIONS = 32;	// about 4 MB with noise step 4, area of render distance 16 spans at most 9 regions
+
+static int FloorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// bilinear interpolation of region lattice at column local_x, local_z of region, same arithmetic as lattice in GenerateHeights
+static inline void SampleClimate(const ClimateRegion& region, int local_x, int local_z, float& continentalness, float& erosion)
+{
+	const int step = region.step;
+	const float tx = (float)(local_x % step) / step;
+	const float tz = (float)(local_z % step) / step;
+	const int i00 = local_x / step + local_z / step * region.size;
+	const int i10 = i00 + 1;
+	const int i01 = i00 + region.size;
+	const int i11 = i01 + 1;
+	const float* c = region.continentalness.data();
+	const float* e = region.erosion.data();
+	continentalness = glm::mix(glm::mix(c[i00], c[i10], tx), glm::mix(c[i01], c[i11], tx), tz);
+	erosion = glm::mix(glm::mix(e[i00], e[i10], tx), glm::mix(e[i01], e[i11], tx), tz);
+}
+
+// SplitMix64 finalizer
+static inline uint64_t MixBits(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	value ^= value >> 31;
+	return value;
+}
+
+// counter based random numbers: n-th number of stream is hash of (stream, n), there is no state to seed (mt19937 seeding was 624 words per column)
+static inline uint64_t CellStream(int seed, int grid_x, int grid_z)
+{
+	const uint64_t cell = (uint64_t)(uint32_t)grid_x << 32 | (uint32_t)grid_z;
+	return MixBits(cell ^ (uint64_t)(uint32_t)seed * 0x9e3779b97f4a7c15ull);
+}
+
+static inline float CellRandom(uint64_t stream, int n)	// [0, 1)
+{
+	return (MixBits(stream + (uint64_t)(n + 1) * 0x9e3779b97f4a7c15ull) >> 40) * (1.0f / (1 << 24));
+}
 
 WorldGenerator::WorldGenerator(int seed)
-	: seed_(seed), octaves_(4), frequency_(0.00052137f), amplitude_(1.0f), persistance_(0.5f), base_height_(128), sea_level_(128)
+	: seed_(seed), octaves_(4), frequency_(0.00052137f), amplitude_(1.0f), persistance_(0.5f), noise_step_(COARSE_NOISE_STEP),
+	climate_cache_enabled_(CLIMATE_CACHE), climate_cache_(CLIMATE_CACHE_REGIONS), density_terrain_(DENSITY_TERRAIN), base_height_(128), sea_level_(128)
 {
 	noise_.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
 	noise_.SetFrequency(1.0f);
 	noise_.SetSeed(seed_);
+	for (int noise = 0; noise < static_cast<int>(DensityNoise::COUNT); ++noise)
+	{
+		density_noise_[noise].SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+		density_noise_[noise].SetFrequency(1.0f);
+		density_noise_[noise].SetSeed(seed_ + 1 + noise);
+	}
 
 	// Example control points, modify as needed
 	continentalness_control_points_ =
@@ -49,32 +104,68 @@ WorldGenerator::WorldGenerator(int seed)
 		{ 0.8f,  38.0f},
 		{ 1.0f,  46.0f},
 	};
+
+	BuildSplineTables();
+}
+
+void WorldGenerator::BuildSplineTables()
+{
+	for (int spline = 0; spline < static_cast<int>(TerrainSpline::COUNT); ++spline)
+	{
+		const auto& points = GetControlPoints(static_cast<TerrainSpline>(spline));
+		spline_tables_[spline].Build(points.front().first, points.back().first, [this, &points](float x) { return SplineInterpolate(x, points); });
+	}
+}
+
+const std::vector<std::pair<float, float>>& WorldGenerator::GetControlPoints(TerrainSpline spline) const
+{
+	switch (spline)
+	{
+	case TerrainSpline::Continentalness:
+		return continentalness_control_points_;
+	case TerrainSpline::Erosion:
+		return erosion_control_points_;
+	default:
+		return peaks_and_valeys_control_points_;
+	}
+}
+
+float WorldGenerator::EvaluateSpline(TerrainSpline spline, float x) const
+{
+	return SplineInterpolate(x, GetControlPoints(spline));
 }
 
 void WorldGenerator::SetSeed(int seed)
 {
 	seed_ = seed;
 	noise_.SetSeed(seed_);
+	for (int noise = 0; noise < static_cast<int>(DensityNoise::COUNT); ++noise)
+		density_noise_[noise].SetSeed(seed_ + 1 + noise);
+	climate_cache_.Clear();
 }
 
 void WorldGenerator::SetOctaves(int octaves)
 {
 	octaves_ = octaves;
+	climate_cache_.Clear();
 }
 
 void WorldGenerator::SetFrequency(float frequency)
 {
 	frequency_ = frequency;
+	climate_cache_.Clear();
 }
 
 void WorldGenerator::SetAmplitude(float amplitude)
 {
 	amplitude_ = amplitude;
+	climate_cache_.Clear();
 }
 
 void WorldGenerator::SetPersistance(float persistance)
 {
 	persistance_ = persistance;
+	climate_cache_.Clear();
 }
 
 void WorldGenerator::SetBaseHeight(int baseHeight)
@@ -87,33 +178,87 @@ void WorldGenerator::SetSeaLevel(int seaLevel)
 	sea_level_ = seaLevel;
 }
 
-HeightPayload WorldGenerator::GenerateHeight(int x, int z) const
+void WorldGenerator::SetNoiseStep(int step)
 {
-	HeightPayload height;
+	noise_step_ = std::max(step, 1);
+	climate_cache_.Clear();
+}
 
-	float continentalness = 0.0f;
-	float current_frequency = frequency_;
-	float current_amplitude = amplitude_;
+void WorldGenerator::SetClimateCache(bool enabled)
+{
+	climate_cache_enabled_ = enabled;
+}
 
-	for (int i = 0; i < octaves_; ++i)
+void WorldGenerator::SetDensityTerrain(bool enabled)
+{
+	density_terrain_ = enabled;
+}
+
+uint32_t WorldGenerator::GetSettingsFingerprint() const
+{
+	uint32_t hash = 2166136261u;	// FNV-1a over bytes of every setting
+	const auto add = [&hash](const auto& value)
 	{
-		continentalness += noise_.GetNoise(x * current_frequency, z * current_frequency) * current_amplitude;
-		current_frequency /= persistance_;
-		current_amplitude *= persistance_;
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		for (size_t i = 0; i < sizeof(value); ++i)
+			hash = (hash ^ bytes[i]) * 16777619u;
+	};
+	// climate cache and SIMD noise give same heights, only step of lattice they are interpolated from matters
+	const int height_step = SIMD_NOISE || UsesClimateCache() ? noise_step_ : 1;
+	for (int value : { octaves_, height_step, base_height_, sea_level_, (int)SPLINE_LUT, (int)density_terrain_, OVERHANG_HEIGHT, (int)BlockId::NUM_TYPES })
+		add(value);
+	for (float value : { frequency_, amplitude_, persistance_, overhang_depth_inverse_, cave_threshold_, overhang_rise_inverse_, overhang_threshold_, tree_chance_, tree_grid_size_,
+		tree_jitter_amount_ })
+		add(value);
+	for (float value : density_frequency_)
+		add(value);
+	for (int spline = 0; spline < static_cast<int>(TerrainSpline::COUNT); ++spline)
+		for (const std::pair<float, float>& point : GetControlPoints(static_cast<TerrainSpline>(spline)))
+		{
+			add(point.first);
+			add(point.second);
+		}
+	return hash;
+}
+
+HeightPayload WorldGenerator::GenerateHeight(int x, int z) const
+{
+	float continentalness = 0.0f;
+	float erosion = 0.0f;
+	float current_frequency;
+	float current_amplitude;
+	int current_octaves_;
+	if (UsesClimateCache())
+	{
+		const int region_x = FloorDiv(x, ClimateCache::REGION_SIZE);
+		const int region_z = FloorDiv(z, ClimateCache::REGION_SIZE);
+		SampleClimate(*GetClimateRegion(region_x, region_z), x - region_x * ClimateCache::REGION_SIZE, z - region_z * ClimateCache::REGION_SIZE,
+			continentalness, erosion);
 	}
+	else
+	{
+		current_frequency = frequency_;
+		current_amplitude = amplitude_;
 
+		for (int i = 0; i < octaves_; ++i)
+		{
+			continentalness += noise_.GetNoise(x * current_frequency, z * current_frequency) * current_amplitude;
+			current_frequency /= persistance_;
+			current_amplitude *= persistance_;
+		}
 
 
-	float erosion = 0.0f;
-	current_frequency = frequency_ * 0.63721;
-	current_amplitude = amplitude_;
-	int current_octaves_ = octaves_ + 2;
 
-	for (int i = 0; i < current_octaves_; ++i)
-	{
-		erosion += noise_.GetNoise(x * current_frequency, z * current_frequency) * current_amplitude;
-		current_frequency /= persistance_;
-		current_amplitude *= persistance_;
+		current_frequency = frequency_ * 0.63721;
+		current_amplitude = amplitude_;
+		current_octaves_ = octaves_ + 2;
+
+		for (int i = 0; i < current_octaves_; ++i)
+		{
+			erosion += noise_.GetNoise(x * current_frequency, z * current_frequency) * current_amplitude;
+			current_frequency /= persistance_;
+			current_amplitude *= persistance_;
+		}
 	}
 
 
@@ -129,14 +274,198 @@ HeightPayload WorldGenerator::GenerateHeight(int x, int z) const
 		current_frequency /= persistance_;
 		current_amplitude *= persistance_;
 	}
-	peaks_and_valeys = 1 - abs(3 * abs(peaks_and_valeys) - 2);
 
+	return CombineHeight(x, z, continentalness, erosion, peaks_and_valeys);
+}
+
+// octaves of each channel are summed in same order as in GenerateHeight, so with noise step 1 result is the same
+void WorldGenerator::GenerateHeights(int x, int z, int size_x, int size_z, HeightPayload* heights) const
+{
+	GenerateHeights(x, z, size_x, size_z, heights, GenerationContext::ForCurrentThread());
+}
+
+void WorldGenerator::GenerateHeights(int x, int z, int size_x, int size_z, HeightPayload* heights, GenerationContext& context) const
+{
+	const int count = size_x * size_z;
+	std::vector<float>& channels = context.channels;
+	channels.assign(count * 3, 0.0f);
+	float* continentalness = channels.data();
+	float* erosion = continentalness + count;
+	float* peaks_and_valeys = erosion + count;
+
+	if (noise_step_ == 1)
+	{
+		AccumulateOctaves(x, z, size_x, size_z, 1, frequency_, octaves_, continentalness);
+		AccumulateOctaves(x, z, size_x, size_z, 1, frequency_ * 0.63721, octaves_ + 2, erosion);
+	}
+	else if (UsesClimateCache())
+	{
+		// region lattice is the same as chunk lattice below (aligned to world coordinates), only octaves are not evaluated again,
+		// chunk is inside of one region, other grids are split by regions
+		const int region_size = ClimateCache::REGION_SIZE;
+		for (int region_z = FloorDiv(z, region_size); region_z <= FloorDiv(z + size_z - 1, region_size); ++region_z)
+			for (int region_x = FloorDiv(x, region_size); region_x <= FloorDiv(x + size_x - 1, region_size); ++region_x)
+			{
+				const std::shared_ptr<const ClimateRegion> region = GetClimateRegion(region_x, region_z);
+				const int row_begin = std::max(region_z * region_size - z, 0), row_end = std::min((region_z + 1) * region_size - z, size_z);
+				const int column_begin = std::max(region_x * region_size - x, 0), column_end = std::min((region_x + 1) * region_size - x, size_x);
+				for (int row = row_begin; row < row_end; ++row)
+					for (int column = column_begin; column < column_end; ++column)
+					{
+						const int i = column + row * size_x;
+						SampleClimate(*region, x + column - region_x * region_size, z + row - region_z * region_size, continentalness[i], erosion[i]);
+					}
+			}
+	}
+	else
+	{
+		// lattice is aligned to world coordinates, so neighbour chunks share lattice points and there are no seams,
+		// it covers grid plus one point past it (chunk border), 5x5 points for chunk with step 4
+		const int step = noise_step_;
+		const int lattice_begin_x = FloorDiv(x, step);
+		const int lattice_begin_z = FloorDiv(z, step);
+		const int lattice_size_x = FloorDiv(x + size_x - 1, step) - lattice_begin_x + 2;
+		const int lattice_size_z = FloorDiv(z + size_z - 1, step) - lattice_begin_z + 2;
+		const int lattice_count = lattice_size_x * lattice_size_z;
+		std::vector<float>& lattice = context.lattice;
+		lattice.assign(lattice_count * 2, 0.0f);
+		float* lattice_continentalness = lattice.data();
+		float* lattice_erosion = lattice_continentalness + lattice_count;
+		AccumulateOctaves(lattice_begin_x * step, lattice_begin_z * step, lattice_size_x, lattice_size_z, step, frequency_, octaves_, lattice_continentalness);
+		AccumulateOctaves(lattice_begin_x * step, lattice_begin_z * step, lattice_size_x, lattice_size_z, step, frequency_ * 0.63721, octaves_ + 2, lattice_erosion);
+
+		for (int row = 0; row < size_z; ++row)
+		{
+			const int lattice_z = z + row - lattice_begin_z * step;
+			const int z0 = lattice_z / step;
+			const float tz = (float)(lattice_z % step) / step;
+			for (int column = 0; column < size_x; ++column)
+			{
+				const int lattice_x = x + column - lattice_begin_x * step;
+				const int x0 = lattice_x / step;
+				const float tx = (float)(lattice_x % step) / step;
+				const int i00 = x0 + z0 * lattice_size_x;
+				const int i10 = i00 + 1;
+				const int i01 = i00 + lattice_size_x;
+				const int i11 = i01 + 1;
+				const int i = column + row * size_x;
+				continentalness[i] = glm::mix(glm::mix(lattice_continentalness[i00], lattice_continentalness[i10], tx),
+					glm::mix(lattice_continentalness[i01], lattice_continentalness[i11], tx), tz);
+				erosion[i] = glm::mix(glm::mix(lattice_erosion[i00], lattice_erosion[i10], tx), glm::mix(lattice_erosion[i01], lattice_erosion[i11], tx), tz);
+			}
+		}
+	}
+	// shapes mountains, too high frequency for lattice
+	AccumulateOctaves(x, z, size_x, size_z, 1, frequency_ * 3.21, octaves_ * 2, peaks_and_valeys);
+
+	if (!SPLINE_LUT)
+	{
+		for (int row = 0; row < size_z; ++row)
+			for (int column = 0; column < size_x; ++column)
+			{
+				const int i = column + row * size_x;
+				heights[i] = CombineHeight(x + column, z + row, continentalness[i], erosion[i], peaks_and_valeys[i]);
+			}
+		return;
+	}
 
+	std::vector<uint8_t>& trees = context.tree_columns;
+	trees.resize(count);
+	ShouldPlaceTrees(x, z, size_x, size_z, trees.data());
+
+	// splines of whole grid at once, same arithmetic as SplineTable::Evaluate(float) used by CombineHeight
+	std::vector<float>& splines = context.splines;
+	splines.resize(count * 3);
+	float* continentalness_add = splines.data();
+	float* erosion_multiplayer = continentalness_add + count;
+	float* peaks_and_valeys_add = erosion_multiplayer + count;
+	for (int i = 0; i < count; ++i)
+		peaks_and_valeys[i] = FoldPeaksAndValeys(peaks_and_valeys[i]);
+	GetSplineTable(TerrainSpline::Continentalness).Evaluate(continentalness, continentalness_add, count);
+	GetSplineTable(TerrainSpline::Erosion).Evaluate(erosion, erosion_multiplayer, count);
+	GetSplineTable(TerrainSpline::PeaksAndValeys).Evaluate(peaks_and_valeys, peaks_and_valeys_add, count);
+
+	for (int row = 0; row < size_z; ++row)
+		for (int column = 0; column < size_x; ++column)
+		{
+			const int i = column + row * size_x;
+			heights[i] = HeightFromSplines(x + column, z + row, continentalness[i], erosion[i], peaks_and_valeys[i],
+				continentalness_add[i], erosion_multiplayer[i], peaks_and_valeys_add[i], trees[i]);
+		}
+}
 
+void WorldGenerator::AccumulateOctaves(int x, int z, int size_x, int size_z, int step, float frequency, int octaves, float* out) const
+{
+	float current_amplitude = amplitude_;
+	for (int i = 0; i < octaves; ++i)
+	{
+		NoiseBatch::AccumulatePerlinGrid(seed_, x, z, size_x, size_z, frequency, current_amplitude, out, step);
+		frequency /= persistance_;
+		current_amplitude *= persistance_;
+	}
+}
+
+std::shared_ptr<const ClimateRegion> WorldGenerator::GetClimateRegion(int region_x, int region_z) const
+{
+	return climate_cache_.Get(region_x, region_z, [&](ClimateRegion& region)
+		{
+			const int step = noise_step_;
+			region.step = step;
+			region.size = ClimateCache::REGION_SIZE / step + 1;
+			region.continentalness.assign(region.size * region.size, 0.0f);
+			region.erosion.assign(region.size * region.size, 0.0f);
+			const int region_begin_x = region_x * ClimateCache::REGION_SIZE, region_begin_z = region_z * ClimateCache::REGION_SIZE;
+			AccumulateOctaves(region_begin_x, region_begin_z, region.size, region.size, step, frequency_, octaves_, region.continentalness.data());
+			AccumulateOctaves(region_begin_x, region_begin_z, region.size, region.size, step, frequency_ * 0.63721, octaves_ + 2, region.erosion.data());
+		});
+}
+
+void WorldGenerator::GenerateDensityLattice(int x, int z, int size_x, int size_y, int size_z, float* overhang, float* cave) const
+{
+	const int count = size_x * size_y * size_z;
+	std::fill(overhang, overhang + count, 0.0f);
+	std::fill(cave, cave + count, 0.0f);
+	const int overhang_seed = seed_ + 1 + static_cast<int>(DensityNoise::Overhang);
+	const int cave_seed = seed_ + 1 + static_cast<int>(DensityNoise::Cave);
+	for (int column_z = 0; column_z < size_z; ++column_z)
+		for (int column_x = 0; column_x < size_x; ++column_x)
+		{
+			const int offset = size_y * (column_x + size_x * column_z);
+			const int column_world_x = x + column_x * DENSITY_STEP_XZ;
+			const int column_world_z = z + column_z * DENSITY_STEP_XZ;
+			NoiseBatch::AccumulatePerlinColumn(overhang_seed, column_world_x, 0, column_world_z, size_y, DENSITY_STEP_Y,
+				density_frequency_[static_cast<int>(DensityNoise::Overhang)], 1.0f, overhang + offset);
+			NoiseBatch::AccumulatePerlinColumn(cave_seed, column_world_x, 0, column_world_z, size_y, DENSITY_STEP_Y,
+				density_frequency_[static_cast<int>(DensityNoise::Cave)], 1.0f, cave + offset);
+		}
+}
+
+float WorldGenerator::GetDensityNoise(DensityNoise noise, int x, int y, int z) const
+{
+	const float frequency = density_frequency_[static_cast<int>(noise)];
+	return density_noise_[static_cast<int>(noise)].GetNoise(x * frequency, y * frequency, z * frequency);
+}
+
+HeightPayload WorldGenerator::CombineHeight(int x, int z, float continentalness, float erosion, float peaks_and_valeys) const
+{
+	peaks_and_valeys = FoldPeaksAndValeys(peaks_and_valeys);
+
+	if (SPLINE_LUT)
+		return HeightFromSplines(x, z, continentalness, erosion, peaks_and_valeys,
+			GetSplineTable(TerrainSpline::Continentalness).Evaluate(continentalness),
+			GetSplineTable(TerrainSpline::Erosion).Evaluate(erosion),
+			GetSplineTable(TerrainSpline::PeaksAndValeys).Evaluate(peaks_and_valeys), ShouldPlaceTree(x, z));
+	return HeightFromSplines(x, z, continentalness, erosion, peaks_and_valeys,
+		SplineInterpolate(continentalness, continentalness_control_points_),
+		SplineInterpolate(erosion, erosion_control_points_),
+		SplineInterpolate(peaks_and_valeys, peaks_and_valeys_control_points_), ShouldPlaceTree(x, z));
+}
+
+HeightPayload WorldGenerator::HeightFromSplines(int x, int z, float continentalness, float erosion, float peaks_and_valeys,
+	float continentalness_add, float erosion_multiplayer, float peaks_and_valeys_add, bool tree_column) const
+{
+	HeightPayload height;
 	float height_add = 0.0f;
-	float continentalness_add = SplineInterpolate(continentalness, continentalness_control_points_);
-	float erosion_multiplayer = SplineInterpolate(erosion, erosion_control_points_);
-	float peaks_and_valeys_add = SplineInterpolate(peaks_and_valeys, peaks_and_valeys_control_points_);
 
 	if (continentalness_add > 0.0f)
 		height_add += 0.6f * continentalness_add + 0.4f * continentalness_add * erosion_multiplayer;
@@ -153,7 +482,7 @@ HeightPayload WorldGenerator::GenerateHeight(int x, int z) const
 	height.erosion = erosion;
 	height.peaks_and_valeys = peaks_and_valeys;
 
-	if (GetBlockType(x, height.height, z, height) == BlockId::Grass && ShouldPlaceTree(x, z))
+	if (tree_column && GetBlockType(x, height.height, z, height) == BlockId::Grass)
 		height.should_place_tree = true;
 	else
 		height.should_place_tree = false;
@@ -179,8 +508,6 @@ BlockId WorldGenerator::GetBlockType(int x, int y, int z, HeightPayload height)
 		if (y <= height.height && height.height <= sea_level_ + 1) return BlockId::Sand;
 		else if (y < height.height) return BlockId::Dirt;
 		else if (y == height.height) return BlockId::Grass;
-		else if (height.should_place_tree && y <= height.height + 4 ) return BlockId::Wood; // Instead we should do some decoration phase and place tree there
-		else if (height.should_place_tree && y <= height.height + 8 ) return BlockId::Leaves; // Instead we should do some decoration phase and place tree there
 		else return BlockId::Air;
 	}
 	// Ocean
@@ -193,6 +520,44 @@ BlockId WorldGenerator::GetBlockType(int x, int y, int z, HeightPayload height)
 	}
 }
 
+int WorldGenerator::GetColumnSpans(const HeightPayload& height, BlockSpan* spans) const
+{
+	// same branches as GetBlockType, decided once per column instead of once per block
+	const int surface_begin = height.height - 2;
+	const int surface_end = height.height + 1;
+	int count = 0;
+	auto add = [&spans, &count](BlockId block, int y_begin, int y_end)
+	{
+		y_begin = std::max(y_begin, 0);
+		if (y_begin < y_end)
+			spans[count++] = { block, y_begin, y_end };
+	};
+
+	add(BlockId::Stone, 0, surface_begin);
+	// Landmass
+	if (height.height >= sea_level_)
+	{
+		if (height.continentalness <= 0.0f)	// Beach
+			add(BlockId::Sand, surface_begin, surface_end);
+		else if (height.height > base_height_ + base_height_ * 0.55)
+			add(BlockId::Stone, surface_begin, surface_end);
+		else if (height.height <= sea_level_ + 1)
+			add(BlockId::Sand, surface_begin, surface_end);
+		else
+		{
+			add(BlockId::Dirt, surface_begin, height.height);
+			add(BlockId::Grass, height.height, surface_end);
+		}
+	}
+	// Ocean
+	else
+	{
+		add(BlockId::Sand, surface_begin, surface_end);
+		add(BlockId::Water, surface_end, sea_level_ + 1);
+	}
+	return count;
+}
+
 float WorldGenerator::SplineInterpolate(float x, const std::vector<std::pair<float, float>>& points) const
 {
 	if (x <= points.front().first)
@@ -257,25 +622,22 @@ float WorldGenerator::SplineInterpolate(float x, const std::vector<std::pair<flo
 bool WorldGenerator::ShouldPlaceTree(int x, int z) const
 {
 	// Determine the base grid point
-	int grid_x = static_cast<int>(floor(x / tree_grid_size_));
-	int grid_z = static_cast<int>(floor(z / tree_grid_size_));
-
-	// Create a pseudo-random number generator based on grid position
-	std::mt19937 rng(seed_ + grid_x * 374761393 + grid_z * 668265263);
-	std::uniform_real_distribution<float> jitter_dist(-tree_jitter_amount_, tree_jitter_amount_);
-	std::uniform_real_distribution<float> chance_dist(0.0f, 1.0f);
+	const int grid_x = static_cast<int>(floor(x / tree_grid_size_));
+	const int grid_z = static_cast<int>(floor(z / tree_grid_size_));
+	const uint64_t stream = CellStream(seed_, grid_x, grid_z);
 
 	// Calculate the exact tree position by adding jitter
-	float jittered_x = grid_x * tree_grid_size_ + jitter_dist(rng);
-	float jittered_z = grid_z * tree_grid_size_ + jitter_dist(rng);
+	const float jittered_x = grid_x * tree_grid_size_ + (CellRandom(stream, 0) * 2.0f - 1.0f) * tree_jitter_amount_;
+	const float jittered_z = grid_z * tree_grid_size_ + (CellRandom(stream, 1) * 2.0f - 1.0f) * tree_jitter_amount_;
 
-	// Only place a tree if the jittered position is close to the original point
-	if (std::abs(jittered_x - x) < 1.0f && std::abs(jittered_z - z) < 1.0f)
-	{
-		// Use noise or a random chance to decide if a tree should be placed
-		float chance = chance_dist(rng);
-		return chance < tree_chance_;
-	}
+	// Only place a tree if the jittered position is close to the original point and by chance,
+	// & instead of && so there is no branch and batch loop can be vectorized
+	return (std::abs(jittered_x - x) < 1.0f) & (std::abs(jittered_z - z) < 1.0f) & (CellRandom(stream, 2) < tree_chance_);
+}
 
-	return false;
-}
\ No newline at end of file
+void WorldGenerator::ShouldPlaceTrees(int x, int z, int size_x, int size_z, uint8_t* trees) const
+{
+	for (int row = 0; row < size_z; ++row)
+		for (int column = 0; column < size_x; ++column)
+			trees[column + row * size_x] = ShouldPlaceTree(x + column, z + row);
+}
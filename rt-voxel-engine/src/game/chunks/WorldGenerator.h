@@ -1,10 +1,15 @@
 #pragma once
 
 #include "game/blocks/BlockDatabase.h"
+#include "SplineTable.h"
+#include "ClimateCache.h"
 #include <FastNoiseLite/FastNoiseLite.h>
 #include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <utility>
+#include <algorithm>
 
 struct HeightPayload
 {
@@ -15,23 +20,128 @@ struct HeightPayload
     bool should_place_tree;
 };
 
+// run of same blocks in one column, y_end is exclusive
+struct BlockSpan
+{
+    BlockId block;
+    int y_begin;
+    int y_end;
+};
+const int MAX_COLUMN_SPANS = 4;
+
+class GenerationContext;
+
+// DENSITY_TERRAIN, 3D noise fields sampled on lattice of DENSITY_STEP_XZ x DENSITY_STEP_Y x DENSITY_STEP_XZ blocks
+enum class DensityNoise
+{
+    Overhang = 0,   // hollows under surface band and stone above column top, so terrain hangs over
+    Cave,
+
+    COUNT
+};
+const int DENSITY_STEP_XZ = 4;
+const int DENSITY_STEP_Y = 8;
+const int OVERHANG_HEIGHT = 16;    // density terrain can add stone up to this many blocks above column top
+
+enum class TerrainSpline
+{
+    Continentalness = 0,
+    Erosion,
+    PeaksAndValeys,
+
+    COUNT
+};
+
+// Terrain configuration (noise parameters, splines and their tables), after it is set up it is only read, so one generator is shared
+// by all generating threads, everything written while generating is in GenerationContext. Not copyable, it is too big to copy per chunk.
 class WorldGenerator 
 {
 public:
     WorldGenerator(int seed = 0);
+    WorldGenerator(const WorldGenerator&) = delete;
+    WorldGenerator& operator=(const WorldGenerator&) = delete;
 
     void SetSeed(int seed);
+    inline int GetSeed() const { return seed_; };
     void SetOctaves(int octaves);
     void SetFrequency(float frequency);
     void SetAmplitude(float amplitude);
     void SetPersistance(float persistance);
     void SetBaseHeight(int baseHeight);
     void SetSeaLevel(int seaLevel);
+    void SetNoiseStep(int step);    // 1 is exact, see COARSE_NOISE_STEP in config.h
+    inline int GetNoiseStep() const { return noise_step_; };
+    void SetDensityTerrain(bool enabled);    // see DENSITY_TERRAIN in config.h
+    inline bool GetDensityTerrain() const { return density_terrain_; };
+    // continentalness and erosion lattice (noise step > 1) is read from ClimateCache, same heights, see CLIMATE_CACHE in config.h
+    void SetClimateCache(bool enabled);
+    inline bool GetClimateCache() const { return climate_cache_enabled_; };
+    inline size_t GetClimateRegionBuilds() const { return climate_cache_.GetBuildCount(); };
+    // hash of everything generated blocks depend on besides seed (parameters above, splines, config.h switches that change terrain),
+    // baked regions (BakedRegion) store it, so chunks generated with other settings are not loaded next to these
+    uint32_t GetSettingsFingerprint() const;
 
+    // continentalness and erosion from climate cache when it is used (GenerateHeights with noise step > 1 gives the same heights),
+    // noise of this column otherwise (exact)
     HeightPayload GenerateHeight(int x, int z) const;
-    BlockId GetBlockType(int x, int y, int z, HeightPayload height) const;
+    // same as GenerateHeight for grid of size_x * size_z columns starting at x, z, stored row by row (x + z * size_x),
+    // noise of whole grid is evaluated octave by octave in SIMD lanes (NoiseBatch),
+    // with noise step > 1 low frequency channels (continentalness, erosion) are sampled only on lattice and bilinearly interpolated
+    void GenerateHeights(int x, int z, int size_x, int size_z, HeightPayload* heights, GenerationContext& context) const;
+    void GenerateHeights(int x, int z, int size_x, int size_z, HeightPayload* heights) const;	// with context of current thread
+    BlockId GetBlockType(int x, int y, int z, HeightPayload height) const;	// trees are not included, they are placed by decoration stage
+    // same blocks as GetBlockType, but whole column at once as at most MAX_COLUMN_SPANS spans from the bottom up (air above them
+    // is not included), returns their count, spans are not clipped to chunk height
+    int GetColumnSpans(const HeightPayload& height, BlockSpan* spans) const;
+    // highest y for which GetBlockType returns only stone and highest y for which it can return anything but air
+    inline int GetColumnStoneTop(const HeightPayload& height) const { return height.height - 3; };
+    inline int GetColumnTop(const HeightPayload& height) const { return std::max(height.height, sea_level_); };
+
+    // Density terrain carves stone of column from y 1 up to stone top where density is negative, and adds stone above column top
+    // (up to OVERHANG_HEIGHT) where density is above overhang threshold, so only strong overhang noise builds ledges and arches and
+    // surface is not buried everywhere. Surface band between them stays as it is, so grass and trees on it are kept.
+    // Lattice: size_x * size_z columns DENSITY_STEP_XZ apart starting at x, z (world, multiples of DENSITY_STEP_XZ), each of
+    // size_y points DENSITY_STEP_Y apart from y 0, stored column by column (y + size_y * (column_x + size_x * column_z)), batched noise
+    void GenerateDensityLattice(int x, int z, int size_x, int size_y, int size_z, float* overhang, float* cave) const;
+    inline float CombineDensity(float overhang, float cave, int y, const HeightPayload& height) const
+    {
+        // above surface density falls off slower, so noise changing along y hangs stone over air instead of piling it on surface
+        const float depth = (float)(height.height - y);
+        return std::min(depth * (depth >= 0.0f ? overhang_depth_inverse_ : overhang_rise_inverse_) + overhang, cave_threshold_ - cave);
+    };
+    inline bool IsCarvable(int y, const HeightPayload& height) const { return y >= 1 && y <= GetColumnStoneTop(height); };
+    inline bool IsRaisable(int y, const HeightPayload& height) const
+    {
+        return y > GetColumnTop(height) && y <= GetColumnTop(height) + OVERHANG_HEIGHT;
+    };
+    inline float GetOverhangThreshold() const { return overhang_threshold_; };
+    // exact, noise of single point (FastNoiseLite) instead of lattice, for benchmark
+    float GetDensityNoise(DensityNoise noise, int x, int y, int z) const;
+    inline float GetDensity(int x, int y, int z, const HeightPayload& height) const
+    {
+        return CombineDensity(GetDensityNoise(DensityNoise::Overhang, x, y, z), GetDensityNoise(DensityNoise::Cave, x, y, z), y, height);
+    };
+
+    // columns where tree grows if there is grass, independent of terrain, saved worlds rely on it so it must stay the same across versions
+    bool ShouldPlaceTree(int x, int z) const;
+    void ShouldPlaceTrees(int x, int z, int size_x, int size_z, uint8_t* trees) const;	// grid as in GenerateHeights, branch free
+
+    // spline itself (SplineInterpolate) and its table used for generation when SPLINE_LUT is set, for benchmark
+    float EvaluateSpline(TerrainSpline spline, float x) const;
+    inline const SplineTable& GetSplineTable(TerrainSpline spline) const { return spline_tables_[static_cast<int>(spline)]; };
 
 private:
+    // octaves of one noise channel summed into out, grid as in NoiseBatch::AccumulatePerlinGrid
+    void AccumulateOctaves(int x, int z, int size_x, int size_z, int step, float frequency, int octaves, float* out) const;
+    inline bool UsesClimateCache() const { return climate_cache_enabled_ && noise_step_ > 1 && ClimateCache::REGION_SIZE % noise_step_ == 0; };
+    std::shared_ptr<const ClimateRegion> GetClimateRegion(int region_x, int region_z) const;
+    HeightPayload CombineHeight(int x, int z, float continentalness, float erosion, float peaks_and_valeys) const;	// noise channels into height
+    // second half of CombineHeight, splines already evaluated, peaks and valeys already folded
+    HeightPayload HeightFromSplines(int x, int z, float continentalness, float erosion, float peaks_and_valeys,
+        float continentalness_add, float erosion_multiplayer, float peaks_and_valeys_add, bool tree_column) const;
+    inline static float FoldPeaksAndValeys(float noise) { return 1 - abs(3 * abs(noise) - 2); };
+    const std::vector<std::pair<float, float>>& GetControlPoints(TerrainSpline spline) const;
+    void BuildSplineTables();
     float SplineInterpolate(float x, const std::vector<std::pair<float, float>>& points) const;
 
     FastNoiseLite noise_;
@@ -41,16 +151,27 @@ private:
     float amplitude_;
     float persistance_;
 
+    int noise_step_;
+    bool climate_cache_enabled_;
+    mutable ClimateCache climate_cache_;    // synchronized on its own, generator stays shareable between threads
+
+    bool density_terrain_;
+    std::array<FastNoiseLite, static_cast<int>(DensityNoise::COUNT)> density_noise_;   // for GetDensityNoise, seeded seed + 1 + noise
+    std::array<float, static_cast<int>(DensityNoise::COUNT)> density_frequency_ = { 1.0f / 40.0f, 1.0f / 56.0f };
+    float overhang_depth_inverse_ = 1.0f / 16.0f;  // overhang noise of -1 carves up to 16 blocks under surface
+    float cave_threshold_ = 0.5f;                  // cave noise above it is carved
+    float overhang_rise_inverse_ = 1.0f / 64.0f;   // falloff of density above surface
+    float overhang_threshold_ = 0.25f;             // density above column top has to exceed it to add stone
+
     int base_height_;
     int sea_level_;
 
     std::vector<std::pair<float, float>> continentalness_control_points_;
     std::vector<std::pair<float, float>> erosion_control_points_;
     std::vector<std::pair<float, float>> peaks_and_valeys_control_points_;
+    std::array<SplineTable, static_cast<int>(TerrainSpline::COUNT)> spline_tables_;
 
     float tree_chance_ = 0.20f; // 20% chance of tree spawning on a grass block
     float tree_grid_size_ = 4.0f;  // Distance between grid points
     float tree_jitter_amount_ = 3.0f;  // Maximum random offset from grid point
-
-    bool ShouldPlaceTree(int x, int z) const;
 };
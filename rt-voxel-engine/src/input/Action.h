@@ -6,6 +6,7 @@ enum class Action
 {
     CLOSE_APP,
     WIRE_FRAME_MODE,
+    TOGGLE_GREEDY_MESHING,
     MOVE_FORWARD,
     MOVE_BACKWARD,
     MOVE_LEFT,
@@ -25,6 +26,7 @@ inline Action stringToAction(const std::string& actionStr)
 {
     if (actionStr == "CLOSE_APP") return Action::CLOSE_APP;
     if (actionStr == "WIRE_FRAME_MODE") return Action::WIRE_FRAME_MODE;
+    if (actionStr == "TOGGLE_GREEDY_MESHING") return Action::TOGGLE_GREEDY_MESHING;
     if (actionStr == "MOVE_FORWARD") return Action::MOVE_FORWARD;
     if (actionStr == "MOVE_BACKWARD") return Action::MOVE_BACKWARD;
     if (actionStr == "MOVE_LEFT") return Action::MOVE_LEFT;
@@ -9,7 +9,8 @@ using namespace std::chrono;
 RendererRT::RendererRT()
 	: vulkan_(),
 	camera_(nullptr),
-	rebuild_required_(true)
+	rebuild_required_(true),
+	update_required_(false)
 {
 
 }
@@ -38,6 +39,7 @@ void RendererRT::Init(int width, int height)
 	vulkan_.CreateTextureSampler();
 	vulkan_.CreateCommandBuffer();
 	vulkan_.CreateUniformBuffer();
+	vulkan_.CreateQuadIndexBuffer();
 	vulkan_.CreateSyncObjects();
 }
 
@@ -51,16 +53,16 @@ void RendererRT::SetCamera(const Camera* camera)
 	camera_ = camera;
 }
 
-BottomLevelAccelerationStructure RendererRT::BuildBlas(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+BottomLevelAccelerationStructure RendererRT::BuildBlas(const std::vector<uint32_t>& vertices, const MeshLayerOffsets& layer_offsets, const glm::vec3& position)
 {
 	static int currently_building = 0;
 	static 	std::mutex mutex;
 
 	mutex.lock();
-	if (++currently_building > 1000)
+	if (++currently_building > 64 || vulkan_.StagingOverBudget())
 		currently_building = vulkan_.ProcessPendingCleanups();
 	mutex.unlock();
-	return vulkan_.BuildBLAS(vertices, indices);
+	return vulkan_.BuildBLAS(vertices, layer_offsets, position);
 }
 
 bool RendererRT::IsBlasBuilded(BottomLevelAccelerationStructure acceleration_structure)
@@ -84,16 +86,18 @@ void RendererRT::Render(const ChunkManager& chunk_manager)
 {
 	//TODO in RT rendered accumulating meshes instead of drawing one by one is forced, which is good for us
 	//chunk_manager.Draw();
-	if (rebuild_required_)
+	vulkan_.ProcessPendingCleanups();	// staging of BLAS builds finished since last frame
+	if (rebuild_required_ || update_required_)
 	{
 		auto start = high_resolution_clock::now();
 		std::vector<BottomLevelAccelerationStructure> blases = chunk_manager.GetAllBLAS();
-		vulkan_.BuildTLAS(blases);
-		vulkan_.UpdateDescriptorSet();
-		rebuild_required_ = false;
+		vulkan_.BuildTLAS(blases, !rebuild_required_);
+		vulkan_.UpdateDescriptorSet();	// vertex buffer addresses are new buffer either way
 		auto stop = high_resolution_clock::now();
 		auto duration = duration_cast<milliseconds>(stop - start);
-		std::cout << "Rebuild time: " << duration.count() << std::endl;
+		std::cout << (rebuild_required_ ? "Rebuild time: " : "Update time: ") << duration.count() << std::endl;
+		rebuild_required_ = false;
+		update_required_ = false;
 	}
 	static int frame_count = 0;
 	static float elapsed_time = 0;
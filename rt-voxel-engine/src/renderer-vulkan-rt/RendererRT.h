@@ -15,15 +15,17 @@ public:
     void Init(int width, int height);
     void SetWindow(Window* window);
     void SetCamera(const Camera* camera);
-    BottomLevelAccelerationStructure BuildBlas(const std::vector<float>& vertices, const  std::vector<unsigned int>& indices);
+    BottomLevelAccelerationStructure BuildBlas(const std::vector<uint32_t>& vertices, const MeshLayerOffsets& layer_offsets, const glm::vec3& position);
     bool IsBlasBuilded(BottomLevelAccelerationStructure acceleration_structure);
     void FreeBlas(BottomLevelAccelerationStructure acceleration_structure);
     void Render(const ChunkManager& chunk_manager);
     void WindowSizeChanged(int width, int height);
     void ForceRebuild() { rebuild_required_ = true; };
+    void ForceUpdate() { update_required_ = true; };  // same chunks, only some of their BLAS changed (edits), TLAS is refitted
 
 private:
     VulkanRTCore vulkan_;
     const Camera* camera_;
     bool rebuild_required_;
+    bool update_required_;
 };
@@ -1,10 +1,13 @@
 #ifdef VULKAN
 #include "VulkanRTCore.h"
+#include "game/chunks/ChunkVertex.h"
+#include <glm/gtc/packing.hpp>
 #include <stb/stb_image.h>
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
 #include <algorithm>
+#include <array>
 #define VMA_IMPLEMENTATION
 #include "vma/vk_mem_alloc.h"
 
@@ -513,6 +516,13 @@ void VulkanRTCore::CreateUniformBuffer()
 		uniform_buffers_[i] = CreateDeviceBufferWithHostAccess(sizeof(UniformBuffer), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, false);
 }
 
+void VulkanRTCore::CreateQuadIndexBuffer()
+{
+	const std::vector<unsigned int> indices = ChunkVertex::BuildQuadIndices(ChunkVertex::MAX_QUADS);
+	quad_index_buffer_ = CreateDeviceBufferWithData(indices.data(), sizeof(uint32_t) * (uint32_t)indices.size(),
+		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, true);
+}
+
 void VulkanRTCore::CreateSyncObjects()
 {
 	VkSemaphoreCreateInfo semaphore_info{};
@@ -542,6 +552,7 @@ void VulkanRTCore::Cleanup()
 	CleanupSwapChain();
 
 	vertex_buffer_addresses_.Free(allocator_);
+	quad_index_buffer_.Free(allocator_);
 
 	for (size_t i = 0; i < FRAMES_IN_FLIGHT; i++)
 	{
@@ -582,15 +593,32 @@ void VulkanRTCore::Cleanup()
 	vkDestroyInstance(instance_, nullptr);
 }
 
-BottomLevelAccelerationStructure VulkanRTCore::BuildBLAS(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+BottomLevelAccelerationStructure VulkanRTCore::BuildBLAS(const std::vector<uint32_t>& vertices, const MeshLayerOffsets& layer_offsets, const glm::vec3& position)
 {
 	BottomLevelAccelerationStructure acceleration_structure;
+	acceleration_structure.transform = {
+		1.0f, 0.0f, 0.0f, position.x,
+		0.0f, 1.0f, 0.0f, position.y,
+		0.0f, 0.0f, 1.0f, position.z
+	};
+
+	// BLAS build cannot read packed vertices, so positions are unpacked into temporary half float buffer
+	// (chunk local coordinates are small integers, exact in half float), freed once build is done
+	thread_local std::vector<uint64_t> build_positions;	// reused between builds, same as MeshingArena
+	build_positions.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		build_positions[i] = glm::packHalf4x16(glm::vec4(ChunkVertex::UnpackPosition(vertices[i]), 0.0f));
+
+	// closest hit shader gets primitive index relative to geometry (layer), so it needs to know where every layer starts
+	thread_local std::vector<uint32_t> shader_vertices;
+	shader_vertices.assign(layer_offsets.begin(), layer_offsets.end());
+	shader_vertices.insert(shader_vertices.end(), vertices.begin(), vertices.end());
 
 	queue_mutex_.lock();
-	acceleration_structure.vertex_data = CreateDeviceBufferWithData(vertices.data(), sizeof(float) * (uint32_t)vertices.size(),
-		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true);
+	acceleration_structure.vertex_data = CreateDeviceBufferWithData(shader_vertices.data(), sizeof(uint32_t) * (uint32_t)shader_vertices.size(),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true);
 
-	Buffer index_buffer = CreateDeviceBufferWithData(indices.data(), sizeof(uint32_t) * (uint32_t)indices.size(),
+	Buffer position_buffer = CreateDeviceBufferWithData(build_positions.data(), sizeof(uint64_t) * (uint32_t)build_positions.size(),
 		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, true);
 	queue_mutex_.unlock();
 
@@ -598,33 +626,50 @@ BottomLevelAccelerationStructure VulkanRTCore::BuildBLAS(const std::vector<float
 	vertex_buffer_device_address.deviceAddress = GetBufferDeviceAddress(acceleration_structure.vertex_data.buffer);
 	acceleration_structure.vertex_handle = vertex_buffer_device_address.deviceAddress;
 
-	VkDeviceOrHostAddressConstKHR index_buffer_device_address = {};
-	index_buffer_device_address.deviceAddress = GetBufferDeviceAddress(index_buffer.buffer);
+	VkDeviceOrHostAddressConstKHR position_buffer_device_address = {};
+	position_buffer_device_address.deviceAddress = GetBufferDeviceAddress(position_buffer.buffer);
 
-	VkAccelerationStructureGeometryKHR as_geometry_info = {};
-	as_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-	as_geometry_info.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-	as_geometry_info.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-	as_geometry_info.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-	as_geometry_info.geometry.triangles.vertexData = vertex_buffer_device_address;
-	as_geometry_info.geometry.triangles.vertexStride = sizeof(float) * 5;	//TODO U KNOW WHAT
-	as_geometry_info.geometry.triangles.maxVertex = vertices.size();
-	as_geometry_info.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
-	as_geometry_info.geometry.triangles.indexData = index_buffer_device_address;
-	as_geometry_info.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+	VkDeviceOrHostAddressConstKHR index_buffer_device_address = {};
+	index_buffer_device_address.deviceAddress = GetBufferDeviceAddress(quad_index_buffer_.buffer);
+
+	// one geometry per MeshLayer, all share position and index buffer, layer is selected by firstVertex of build range.
+	// Water is not opaque, so shadow rays can cull it (gl_RayFlagsCullNoOpaqueEXT). Leaves stay opaque until there is
+	// any hit shader doing alpha test, for now they are separate only so closest hit shader can tell them apart.
+	std::array<VkAccelerationStructureGeometryKHR, MESH_LAYER_COUNT> as_geometry_infos = {};
+	std::array<VkAccelerationStructureBuildRangeInfoKHR, MESH_LAYER_COUNT> as_build_range_infos = {};
+	std::array<uint32_t, MESH_LAYER_COUNT> primitive_counts;
+	for (int layer = 0; layer < MESH_LAYER_COUNT; ++layer)
+	{
+		VkAccelerationStructureGeometryKHR& as_geometry_info = as_geometry_infos[layer];
+		as_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+		as_geometry_info.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+		as_geometry_info.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+		as_geometry_info.geometry.triangles.vertexFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+		as_geometry_info.geometry.triangles.vertexData = position_buffer_device_address;
+		as_geometry_info.geometry.triangles.vertexStride = sizeof(uint64_t);
+		as_geometry_info.geometry.triangles.maxVertex = vertices.size();
+		as_geometry_info.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
+		as_geometry_info.geometry.triangles.indexData = index_buffer_device_address;
+		as_geometry_info.flags = static_cast<MeshLayer>(layer) == MeshLayer::Refractive ? 0 : VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+		primitive_counts[layer] = (layer_offsets[layer + 1] - layer_offsets[layer]) / 4 * 2;
+		as_build_range_infos[layer].primitiveCount = primitive_counts[layer];
+		as_build_range_infos[layer].primitiveOffset = 0;
+		as_build_range_infos[layer].firstVertex = layer_offsets[layer];
+		as_build_range_infos[layer].transformOffset = 0;
+	}
 
 	VkAccelerationStructureBuildGeometryInfoKHR as_build_geometry_info = {};
 	as_build_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 	as_build_geometry_info.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
 	as_build_geometry_info.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
 	as_build_geometry_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-	as_build_geometry_info.geometryCount = 1;
-	as_build_geometry_info.pGeometries = &as_geometry_info;
+	as_build_geometry_info.geometryCount = MESH_LAYER_COUNT;
+	as_build_geometry_info.pGeometries = as_geometry_infos.data();
 
-	const uint32_t primitive_count = indices.size() / 3;
 	VkAccelerationStructureBuildSizesInfoKHR as_build_sizes_info = {};
 	as_build_sizes_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	vkGetAccelerationStructureBuildSizesKHR(device_, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &as_build_geometry_info, &primitive_count, &as_build_sizes_info);
+	vkGetAccelerationStructureBuildSizesKHR(device_, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &as_build_geometry_info, primitive_counts.data(), &as_build_sizes_info);
 
 	acceleration_structure.buffer = CreateDeviceBuffer(as_build_sizes_info.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, false);
 
@@ -641,12 +686,7 @@ BottomLevelAccelerationStructure VulkanRTCore::BuildBLAS(const std::vector<float
 	as_build_geometry_info.dstAccelerationStructure = acceleration_structure.as;
 	as_build_geometry_info.scratchData.deviceAddress = GetBufferDeviceAddress(scratch_buffer.buffer);
 
-	VkAccelerationStructureBuildRangeInfoKHR as_build_range_info = {};
-	as_build_range_info.primitiveCount = primitive_count;
-	as_build_range_info.primitiveOffset = 0;
-	as_build_range_info.firstVertex = 0;
-	as_build_range_info.transformOffset = 0;
-	std::vector<VkAccelerationStructureBuildRangeInfoKHR*> as_build_range_infos = { &as_build_range_info };
+	const VkAccelerationStructureBuildRangeInfoKHR* p_as_build_range_infos = as_build_range_infos.data();
 
 	VkFenceCreateInfo fence_info{};
 	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -657,20 +697,22 @@ BottomLevelAccelerationStructure VulkanRTCore::BuildBLAS(const std::vector<float
 	acceleration_structure.build_status = stupid_fence;
 
 	DeferredCleanup cleanup;
-	cleanup.buffers_to_free.push_back(index_buffer);
+	cleanup.buffers_to_free.push_back(position_buffer);
 	cleanup.buffers_to_free.push_back(scratch_buffer);
+	cleanup.staging_size = sizeof(uint64_t) * build_positions.size() + as_build_sizes_info.buildScratchSize;
 	cleanup.ready_for_cleanup = stupid_fence;
 
 	queue_mutex_.lock();
 	cleanup.command_buffer = BeginSingleTimeCommands();
 
-	vkCmdBuildAccelerationStructuresKHR(cleanup.command_buffer, 1, &as_build_geometry_info, as_build_range_infos.data());
+	vkCmdBuildAccelerationStructuresKHR(cleanup.command_buffer, 1, &as_build_geometry_info, &p_as_build_range_infos);
 
 	EndSingleTimeCommands(cleanup.command_buffer, acceleration_structure.build_status);
 	queue_mutex_.unlock();
 
 	cleanup_mutex_.lock();
 	pending_cleanups_.push_back(cleanup);
+	pending_staging_size_ += cleanup.staging_size;
 	cleanup_mutex_.unlock();
 
 	//vertex_buffer.Free(allocator_);
@@ -697,9 +739,12 @@ int VulkanRTCore::ProcessPendingCleanups()	// async BLAS build
 {
 	size_t swapable = 0;
 	std::lock_guard<std::mutex> lock(cleanup_mutex_);
+	const bool wait = StagingOverBudget();	// GPU is behind, waiting frees all of it
 
 	while (swapable < pending_cleanups_.size())
 	{
+		if (wait)
+			ASSERT_VK_RESULT(vkWaitForFences(device_, 1, pending_cleanups_.back().ready_for_cleanup, VK_TRUE, UINT64_MAX));
 		VkResult result = vkGetFenceStatus(device_, pending_cleanups_.back().ready_for_cleanup);
 
 		if (result == VK_SUCCESS) 
@@ -707,6 +752,7 @@ int VulkanRTCore::ProcessPendingCleanups()	// async BLAS build
 			// GPU work is done, free the buffers associated with this cleanup
 			for (auto& buffer : pending_cleanups_.back().buffers_to_free) 
 				buffer.Free(allocator_);
+			pending_staging_size_ -= pending_cleanups_.back().staging_size;
 			queue_mutex_.lock();
 			vkFreeCommandBuffers(device_, command_pool_, 1, &pending_cleanups_.back().command_buffer);
 			pending_cleanups_.back().ready_for_cleanup.Free(device_, nullptr);
@@ -732,24 +778,17 @@ void VulkanRTCore::FreeBLAS(BottomLevelAccelerationStructure acceleration_struct
 	vkDestroyAccelerationStructureKHR(device_, acceleration_structure.as, nullptr);
 }
 
-void VulkanRTCore::BuildTLAS(std::vector<BottomLevelAccelerationStructure> blases)
+void VulkanRTCore::BuildTLAS(std::vector<BottomLevelAccelerationStructure> blases, bool update)
 {
 	//while (ProcessPendingCleanups())
 	//	std::cout << "Waited" << std::endl;	//TODO better wait for all blases being build
 
-	VkTransformMatrixKHR instance_transform = {
-		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f
-	};
-
 	std::vector<VkAccelerationStructureInstanceKHR> instances;
 	std::vector<VkDeviceAddress> vertex_buffer_addresses;
 	instances.reserve(blases.size());
 	vertex_buffer_addresses.reserve(blases.size());
 
 	VkAccelerationStructureInstanceKHR instance = {};
-	instance.transform = instance_transform;
 	instance.mask = 0xFF;
 	instance.instanceShaderBindingTableRecordOffset = 0;
 	instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;	//TODO CULL ON
@@ -759,6 +798,7 @@ void VulkanRTCore::BuildTLAS(std::vector<BottomLevelAccelerationStructure> blase
 		if (!blases[i].builded)
 			vkWaitForFences(device_, 1, &blases[i].build_status.fence, VK_TRUE, UINT64_MAX);
 		instance.instanceCustomIndex = i;
+		instance.transform = blases[i].transform;
 		instance.accelerationStructureReference = blases[i].handle;
 		instances.push_back(instance);
 		vertex_buffer_addresses.push_back(blases[i].vertex_handle);
@@ -787,7 +827,7 @@ void VulkanRTCore::BuildTLAS(std::vector<BottomLevelAccelerationStructure> blase
 	VkAccelerationStructureBuildGeometryInfoKHR as_build_geometry_info = {};
 	as_build_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 	as_build_geometry_info.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-	as_build_geometry_info.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+	as_build_geometry_info.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
 	as_build_geometry_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
 	as_build_geometry_info.geometryCount = 1;
 	as_build_geometry_info.pGeometries = &as_geometry_info;
@@ -797,23 +837,37 @@ void VulkanRTCore::BuildTLAS(std::vector<BottomLevelAccelerationStructure> blase
 	as_build_sizes_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 	vkGetAccelerationStructureBuildSizesKHR(device_, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &as_build_geometry_info, &instance_count, &as_build_sizes_info);
 
-	if (tlas_.as != VK_NULL_HANDLE)
+	// refit keeps tree of last build and only recomputes its bounds, frames in flight still trace it, so they are waited for
+	update = update && tlas_.as != VK_NULL_HANDLE && instance_count == tlas_instance_count_;
+	if (update)
 	{
-		tlas_.Free(allocator_);
-		vkDestroyAccelerationStructureKHR(device_, tlas_.as, nullptr);
+		for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
+			ASSERT_VK_RESULT(vkWaitForFences(device_, 1, &in_flight_fences_[i], VK_TRUE, UINT64_MAX));
+		as_build_geometry_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+		as_build_geometry_info.srcAccelerationStructure = tlas_.as;
 	}
+	else
+	{
+		if (tlas_.as != VK_NULL_HANDLE)
+		{
+			tlas_.Free(allocator_);
+			vkDestroyAccelerationStructureKHR(device_, tlas_.as, nullptr);
+		}
 
-	tlas_.buffer = CreateDeviceBuffer(as_build_sizes_info.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, false);
+		tlas_.buffer = CreateDeviceBuffer(as_build_sizes_info.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, false);
 
-	VkAccelerationStructureCreateInfoKHR as_info = {};
-	as_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-	as_info.buffer = tlas_.VkBuffer();
-	as_info.size = as_build_sizes_info.accelerationStructureSize;
-	as_info.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+		VkAccelerationStructureCreateInfoKHR as_info = {};
+		as_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+		as_info.buffer = tlas_.VkBuffer();
+		as_info.size = as_build_sizes_info.accelerationStructureSize;
+		as_info.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
 
-	ASSERT_VK_RESULT(vkCreateAccelerationStructureKHR(device_, &as_info, nullptr, &tlas_.as));
+		ASSERT_VK_RESULT(vkCreateAccelerationStructureKHR(device_, &as_info, nullptr, &tlas_.as));
+		tlas_instance_count_ = instance_count;
+	}
 
-	Buffer scratch_buffer = CreateDeviceBuffer(as_build_sizes_info.buildScratchSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, true);
+	const VkDeviceSize scratch_size = update ? as_build_sizes_info.updateScratchSize : as_build_sizes_info.buildScratchSize;
+	Buffer scratch_buffer = CreateDeviceBuffer(scratch_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, true);
 
 	as_build_geometry_info.dstAccelerationStructure = tlas_.as;
 	as_build_geometry_info.scratchData.deviceAddress = GetBufferDeviceAddress(scratch_buffer.buffer);	// TODO VMA go with alignment of 16, while 128 is required, this is simple fix
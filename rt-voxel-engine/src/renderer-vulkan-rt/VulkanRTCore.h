@@ -2,12 +2,14 @@
 
 #include "Window.h"
 #include "UniformBuffer.h"
+#include "game/chunks/MeshLayer.h"
 #include <vector>
 #include <iostream>
 #include <optional>
 #include <vulkan/vulkan.h>
 #define VMA_STATIC_VULKAN_FUNCTIONS 1
 #include "vma/vk_mem_alloc.h"
+#include <atomic>
 #include <mutex>
 
 #define RESOLVE_VK_DEVICE_PFN(device, funcName)												\
@@ -152,8 +154,9 @@ struct BottomLevelAccelerationStructure
 	Buffer buffer;
 	VkDeviceAddress handle;
 
-	Buffer vertex_data;
+	Buffer vertex_data;		// MeshLayerOffsets followed by packed vertices (see ChunkVertex.h), read by closest hit shader
 	VkDeviceAddress vertex_handle;
+	VkTransformMatrixKHR transform;	// vertices are chunk local
 
 	bool builded; //not used
 	StupidFence build_status;
@@ -196,6 +199,7 @@ struct DeferredCleanup
 	StupidFence ready_for_cleanup;
 	VkCommandBuffer command_buffer;
 	std::vector<Buffer> buffers_to_free;
+	VkDeviceSize staging_size = 0;	// of buffers_to_free, see BLAS_STAGING_BUDGET
 };
 
 class VulkanRTCore
@@ -220,16 +224,19 @@ public:
 	void CreateTextureSampler();
 	void CreateCommandBuffer();
 	void CreateUniformBuffer();
+	void CreateQuadIndexBuffer();
 	void CreateSyncObjects();
 
 	void Cleanup();
 
 	//Update functions
-	BottomLevelAccelerationStructure BuildBLAS(const std::vector<float>& vertices, const  std::vector<unsigned int>& indices);
+	BottomLevelAccelerationStructure BuildBLAS(const std::vector<uint32_t>& vertices, const MeshLayerOffsets& layer_offsets, const glm::vec3& position);
 	bool IsBLASBuilded(BottomLevelAccelerationStructure acceleration_structure);
-	int ProcessPendingCleanups();
+	int ProcessPendingCleanups();	// frees buffers of finished BLAS builds, waits for unfinished ones when they are over budget
+	inline bool StagingOverBudget() const { return pending_staging_size_ > BLAS_STAGING_BUDGET; };
 	void FreeBLAS(BottomLevelAccelerationStructure acceleration_structure);
-	void BuildTLAS(std::vector<BottomLevelAccelerationStructure> blases);
+	// update refits existing TLAS in place (same instance count, only their BLAS changed, e.g. block edits), otherwise it is built again
+	void BuildTLAS(std::vector<BottomLevelAccelerationStructure> blases, bool update = false);
 	void UpdateDescriptorSet();
 	void RecordCommandBuffer(uint32_t swap_chain_image_index);
 	void Render(UniformBuffer uniform_buffer);
@@ -324,11 +331,14 @@ private:
 	std::vector<VkCommandBuffer> command_buffers_;
 
 	AccelerationStructure tlas_;
+	uint32_t tlas_instance_count_ = 0;	// of last build, update needs the same
 
 	std::vector<MappedBuffer> uniform_buffers_;
 
 	Buffer vertex_buffer_addresses_;
 
+	Buffer quad_index_buffer_;	// shared by all BLAS builds, see ChunkVertex::BuildQuadIndices
+
 	std::vector<VkSemaphore> image_available_semaphores_;
 	std::vector<VkSemaphore> render_finished_semaphores_;
 	std::vector<VkFence> in_flight_fences_;
@@ -336,6 +346,10 @@ private:
 	std::mutex cleanup_mutex_;
 
 	std::vector<DeferredCleanup> pending_cleanups_;
+	// half float positions and scratch of BLAS builds are freed once build is done, until then they are counted here,
+	// so streaming in many chunks at once cannot pile up more than budget of them
+	const VkDeviceSize BLAS_STAGING_BUDGET = 64ull * 1024 * 1024;
+	std::atomic<VkDeviceSize> pending_staging_size_{ 0 };
 
 	const std::vector<const char*> validation_layers_ =
 	{
@@ -1,23 +1,34 @@
 #include "Mesh.h"
+#include "game/chunks/ChunkVertex.h"
 
-Mesh::Mesh(const std::vector<float>& vertices, const  std::vector<unsigned int>& indices)
+// created on first use (needs GL context), never freed, it lives as long as the context
+static EBO& GetQuadEBO()
+{
+	static EBO* quad_ebo = nullptr;
+	if (quad_ebo == nullptr)
+	{
+		const std::vector<unsigned int> indices = ChunkVertex::BuildQuadIndices(ChunkVertex::MAX_QUADS);
+		quad_ebo = new EBO(indices.data(), indices.size());
+	}
+	return *quad_ebo;
+}
+
+Mesh::Mesh(const std::vector<uint32_t>& vertices, const glm::vec3& position)
 	//: vertices_(vertices), indices_(indices), vao_(),
 	//vbo_(vertices_.data(), vertices_.size() * sizeof(float)),
 	//ebo_(indices_.data(), indices_.size())
-	: indices_count_(indices.size()), vao_(),
-	vbo_(vertices.data(), vertices.size() * sizeof(float)),
-	ebo_(indices.data(), indices.size())
+	: indices_count_(vertices.size() / 4 * 6), position_(position), vao_(),
+	vbo_(vertices.data(), vertices.size() * sizeof(uint32_t))
 {
-	vao_.BindBuffers(vbo_, ebo_);
+	vao_.BindBuffers(vbo_, GetQuadEBO());
 
 	//TODO for now vertex layout is hardcoded same goes for types
-	vao_.LinkAttrib(0, 3, GL_FLOAT, 6 * sizeof(float), (void*)0);
-	vao_.LinkAttrib(1, 2, GL_FLOAT, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-	vao_.LinkAttrib(2, 1, GL_FLOAT, 6 * sizeof(float), (void*)(5 * sizeof(float)));	//temporary simple lighting
+	vao_.LinkAttribI(0, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);	// packed, see ChunkVertex.h
 }
 
-void Mesh::Draw()
+void Mesh::Draw(Shader& shader)
 {
+	shader.SetUniform3f("mesh_position", position_.x, position_.y, position_.z);
 	vao_.Bind();
 	glDrawElements(GL_TRIANGLES, indices_count_, GL_UNSIGNED_INT, 0);
 	vao_.Unbind();
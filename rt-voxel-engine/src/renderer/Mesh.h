@@ -1,7 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 #include "VAO.h"
+#include "Shader.h"
 
 class Mesh
 {
@@ -10,13 +12,13 @@ private:
 	//std::vector <unsigned int> indices_;	// but in the future it could be beneficial to store it on CPU so, chunks that are 
 	//										// unloaded from the GPU can be loaded again without rebuilding mesh
 
-	unsigned int indices_count_;
+	unsigned int indices_count_;	// indices come from quad EBO shared by all meshes
+	glm::vec3 position_;	// vertices are relative to it, see ChunkVertex.h
 
 	VAO vao_;
 	VBO vbo_;
-	EBO ebo_;
 public:
-	Mesh(const std::vector <float>& vertices, const  std::vector <unsigned int>& indices);
-	void Draw();
+	Mesh(const std::vector <uint32_t>& vertices, const glm::vec3& position);
+	void Draw(Shader& shader);
 };
 
@@ -54,7 +54,7 @@ void Renderer::Render(const ChunkManager& chunk_manager)
 	shader_.SetUniformMat4f("view", camera_->GetViewMatrix());
 	shader_.SetUniformMat4f("projection", camera_->GetProjectionMatrix());
 
-	chunk_manager.Draw();
+	chunk_manager.Draw(shader_);
 	auto stop = high_resolution_clock::now();
 	auto duration = duration_cast<microseconds>(stop - start);
 	++frame_count;
@@ -19,6 +19,7 @@ public:
 	//TODO in future add more SetUniform variants if needed
 	void SetUniform1i(const std::string& name, int value);
 	void SetUniform1f(const std::string& name, float value);
+	void SetUniform3f(const std::string& name, float v0, float v1, float v2);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
 	void SetTexture(const std::string& name, const GLuint slot, const Texture& texture);
@@ -26,6 +26,14 @@ void VAO::LinkAttrib(GLuint index, GLuint num_components, GLenum type, GLsizeipt
 	Unbind();
 }
 
+void VAO::LinkAttribI(GLuint index, GLuint num_components, GLenum type, GLsizeiptr stride, void* offset)
+{
+	Bind();
+	glVertexAttribIPointer(index, num_components, type, stride, offset);
+	glEnableVertexAttribArray(index);
+	Unbind();
+}
+
 void VAO::Bind()
 {
 	glBindVertexArray(handle_);
@@ -14,6 +14,7 @@ public:
 
 	void BindBuffers(VBO& VBO, EBO& EBO);
 	void LinkAttrib(GLuint layout, GLuint num_components, GLenum type, GLsizeiptr stride, void* offset);
+	void LinkAttribI(GLuint layout, GLuint num_components, GLenum type, GLsizeiptr stride, void* offset);	// integer attribute, not converted to float
 	void Bind();
 	void Unbind();
 };
\ No newline at end of file